@@ -4,6 +4,7 @@
 #include <ostream>
 #include <string>
 #include <optional>
+#include <vector>
 
 namespace slr {
 namespace args {
@@ -21,6 +22,28 @@ public:
     std::optional<std::string>      getOutputFilename   ()                              const noexcept;
     bool                            getHelp             ()                              const noexcept;
     bool                            getVerbose          ()                              const noexcept;
+    bool                            getFast             ()                              const noexcept;
+    size_t                          getTraceLimit       ()                              const noexcept;
+    std::string_view                getLexer            ()                              const noexcept;
+    const std::vector<std::string>& getBatchInputs      ()                              const noexcept;
+    std::optional<std::string>      getManifest         ()                              const noexcept;
+    bool                            isBatch             ()                              const noexcept;
+    size_t                          getJobs             ()                              const noexcept;
+    std::optional<std::string>      getGrammar          ()                              const noexcept;
+    std::optional<std::string>      getLookahead        ()                              const noexcept;
+    std::optional<std::string>      getDumpTable        ()                              const noexcept;
+    std::optional<std::string>      getLoadTable        ()                              const noexcept;
+    bool                            getRuntimeTable     ()                              const noexcept;
+    bool                            getAst              ()                              const noexcept;
+    bool                            getRecover          ()                              const noexcept;
+    bool                            getEval             ()                              const noexcept;
+    const std::vector<std::string>& getVariables        ()                              const noexcept;
+    bool                            getCompile          ()                              const noexcept;
+    std::optional<std::string>      getBindings         ()                              const noexcept;
+    std::optional<std::string>      getColumns          ()                              const noexcept;
+    size_t                          getCache            ()                              const noexcept;
+    std::string_view                getCacheEviction    ()                              const noexcept;
+    std::optional<std::string>      getEdits            ()                              const noexcept;
 
 private:
 
@@ -29,6 +52,27 @@ private:
     std::optional<std::string> output_filename_ = std::nullopt;
     bool help_ = false;
     bool verbose_ = false;
+    bool fast_ = false;
+    size_t trace_limit_ = 0;
+    std::string lexer_ = "flex";
+    std::vector<std::string> batch_inputs_;
+    std::optional<std::string> manifest_ = std::nullopt;
+    size_t jobs_ = 1;
+    std::optional<std::string> grammar_ = std::nullopt;
+    std::optional<std::string> lookahead_ = std::nullopt;
+    std::optional<std::string> dump_table_ = std::nullopt;
+    std::optional<std::string> load_table_ = std::nullopt;
+    bool runtime_table_ = false;
+    bool ast_ = false;
+    bool recover_ = false;
+    bool eval_ = false;
+    std::vector<std::string> variables_;
+    bool compile_ = false;
+    std::optional<std::string> bindings_ = std::nullopt;
+    std::optional<std::string> columns_ = std::nullopt;
+    size_t cache_ = 0;
+    std::string cache_eviction_ = "lru";
+    std::optional<std::string> edits_ = std::nullopt;
 };
 
 }
@@ -2,8 +2,11 @@
 
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <optional>
 
+#include "utils/MappedFile.hpp"
+
 namespace slr {
 namespace args {
 
@@ -26,15 +29,19 @@ public:
 
     std::optional<std::string> getInputFilename    ()  const noexcept;
     std::optional<std::string> getOutputFilename   ()  const noexcept;
-    std::istream&              getInputFile        ()        noexcept;
+    // Весь вход целиком; живёт, пока жив IOManger. stdin читается при первом вызове
+    std::string_view           getInputBuffer      ()               ;
+    // Поток входа без буферизации целиком: только stdin, файл всегда читается через getInputBuffer
+    std::istream&              getInputStream      ()        noexcept;
     std::ostream&              getOutputFile       ()        noexcept;
 
 private:
 
-    std::optional<std::string> input_filename_  = std::nullopt;
-    std::optional<std::string> output_filename_ = std::nullopt;
-    std::ifstream              input_file_                    ;
-    std::ofstream              output_file_                   ;
+    std::optional<std::string>       input_filename_  = std::nullopt;
+    std::optional<std::string>       output_filename_ = std::nullopt;
+    std::optional<utils::MappedFile> input_file_                     ;
+    std::optional<std::string>       input_storage_   = std::nullopt;
+    std::ofstream                    output_file_                    ;
 };
 
 }
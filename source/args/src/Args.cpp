@@ -1,11 +1,27 @@
 #include "args/Args.hpp"
 
+#include <charconv>
 #include <iostream>
 #include <cstring>
 
 namespace slr {
 namespace args {
 
+namespace {
+
+// Неотрицательное целое целиком, без знака и мусора после числа
+std::optional<size_t> parseCount(std::string_view text) {
+    size_t value = 0;
+    const char* const text_end = text.data() + text.size();
+    const auto [end, error] = std::from_chars(text.data(), text_end, value);
+    if (error != std::errc{} || end != text_end) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+}
+
 Args::Args(const int argc, const char* const argv[])
     :   program_name_(argv[0])
 {
@@ -18,6 +34,9 @@ Args::Args(const int argc, const char* const argv[])
         else if (arg == "-v" || arg == "--verbose") {
             verbose_ = true;
         }
+        else if (arg == "-f" || arg == "--fast") {
+            fast_ = true;
+        }
         else if (arg == "-i" || arg == "--input") {
             if (arg_ind + 1 < static_cast<size_t>(argc)) {
                 input_filename_ = argv[++arg_ind];
@@ -26,6 +45,177 @@ Args::Args(const int argc, const char* const argv[])
                 std::cerr << "Error: --input requires an argument\n";
                 help_ = true;
             }
+        }
+        else if (arg == "--trace-limit") {
+            if (arg_ind + 1 < static_cast<size_t>(argc)) {
+                const auto trace_limit = parseCount(argv[++arg_ind]);
+                if (trace_limit.has_value()) {
+                    trace_limit_ = *trace_limit;
+                }
+                else {
+                    std::cerr << "Error: --trace-limit requires a non-negative integer\n";
+                    help_ = true;
+                }
+            }
+            else {
+                std::cerr << "Error: --trace-limit requires an argument\n";
+                help_ = true;
+            }
+        }
+        else if (arg == "--lexer") {
+            if (arg_ind + 1 < static_cast<size_t>(argc)) {
+                lexer_ = argv[++arg_ind];
+            }
+            else {
+                std::cerr << "Error: --lexer requires an argument\n";
+                help_ = true;
+            }
+        }
+        else if (arg == "-b" || arg == "--batch") {
+            if (arg_ind + 1 < static_cast<size_t>(argc)) {
+                batch_inputs_.push_back(argv[++arg_ind]);
+            }
+            else {
+                std::cerr << "Error: --batch requires an argument\n";
+                help_ = true;
+            }
+        }
+        else if (arg == "--manifest") {
+            if (arg_ind + 1 < static_cast<size_t>(argc)) {
+                manifest_ = argv[++arg_ind];
+            }
+            else {
+                std::cerr << "Error: --manifest requires an argument\n";
+                help_ = true;
+            }
+        }
+        else if (arg == "-j" || arg == "--jobs") {
+            if (arg_ind + 1 < static_cast<size_t>(argc)) {
+                const auto jobs = parseCount(argv[++arg_ind]);
+                if (jobs.has_value()) {
+                    jobs_ = *jobs;
+                }
+                else {
+                    std::cerr << "Error: --jobs requires a non-negative integer\n";
+                    help_ = true;
+                }
+            }
+            else {
+                std::cerr << "Error: --jobs requires an argument\n";
+                help_ = true;
+            }
+        }
+        else if (arg == "--dump-table") {
+            if (arg_ind + 1 < static_cast<size_t>(argc)) {
+                dump_table_ = argv[++arg_ind];
+            }
+            else {
+                std::cerr << "Error: --dump-table requires an argument\n";
+                help_ = true;
+            }
+        }
+        else if (arg == "--load-table") {
+            if (arg_ind + 1 < static_cast<size_t>(argc)) {
+                load_table_ = argv[++arg_ind];
+            }
+            else {
+                std::cerr << "Error: --load-table requires an argument\n";
+                help_ = true;
+            }
+        }
+        else if (arg == "-g" || arg == "--grammar") {
+            if (arg_ind + 1 < static_cast<size_t>(argc)) {
+                grammar_ = argv[++arg_ind];
+            }
+            else {
+                std::cerr << "Error: --grammar requires an argument\n";
+                help_ = true;
+            }
+        }
+        else if (arg == "--lookahead") {
+            if (arg_ind + 1 < static_cast<size_t>(argc)) {
+                lookahead_ = argv[++arg_ind];
+            }
+            else {
+                std::cerr << "Error: --lookahead requires an argument\n";
+                help_ = true;
+            }
+        }
+        else if (arg == "--runtime-table") {
+            runtime_table_ = true;
+        }
+        else if (arg == "--ast") {
+            ast_ = true;
+        }
+        else if (arg == "--recover") {
+            recover_ = true;
+        }
+        else if (arg == "--eval") {
+            eval_ = true;
+        }
+        else if (arg == "--compile") {
+            compile_ = true;
+        }
+        else if (arg == "--bindings") {
+            if (arg_ind + 1 < static_cast<size_t>(argc)) {
+                bindings_ = argv[++arg_ind];
+            }
+            else {
+                std::cerr << "Error: --bindings requires an argument\n";
+                help_ = true;
+            }
+        }
+        else if (arg == "--cache") {
+            if (arg_ind + 1 < static_cast<size_t>(argc)) {
+                const auto cache = parseCount(argv[++arg_ind]);
+                if (cache.has_value()) {
+                    cache_ = *cache;
+                }
+                else {
+                    std::cerr << "Error: --cache requires a non-negative integer\n";
+                    help_ = true;
+                }
+            }
+            else {
+                std::cerr << "Error: --cache requires an argument\n";
+                help_ = true;
+            }
+        }
+        else if (arg == "--eviction") {
+            if (arg_ind + 1 < static_cast<size_t>(argc)) {
+                cache_eviction_ = argv[++arg_ind];
+            }
+            else {
+                std::cerr << "Error: --eviction requires an argument\n";
+                help_ = true;
+            }
+        }
+        else if (arg == "--columns") {
+            if (arg_ind + 1 < static_cast<size_t>(argc)) {
+                columns_ = argv[++arg_ind];
+            }
+            else {
+                std::cerr << "Error: --columns requires an argument\n";
+                help_ = true;
+            }
+        }
+        else if (arg == "--edits") {
+            if (arg_ind + 1 < static_cast<size_t>(argc)) {
+                edits_ = argv[++arg_ind];
+            }
+            else {
+                std::cerr << "Error: --edits requires an argument\n";
+                help_ = true;
+            }
+        }
+        else if (arg == "--var") {
+            if (arg_ind + 1 < static_cast<size_t>(argc)) {
+                variables_.push_back(argv[++arg_ind]);
+            }
+            else {
+                std::cerr << "Error: --var requires an argument\n";
+                help_ = true;
+            }
         } else if (arg == "-o" || arg == "--output") {
             if (arg_ind + 1 < static_cast<size_t>(argc)) {
                 output_filename_ = argv[++arg_ind];
@@ -48,7 +238,30 @@ void Args::printHelp(std::ostream& out) const {
            "  -h, --help           Show this help message\n"
            "  -v, --verbose        Enable verbose output\n"
            "  -i, --input <FILE>   Specify input file\n"
-           "  -o, --output <FILE>  Specify output file\n";
+           "  -o, --output <FILE>  Specify output file\n"
+           "  -f, --fast           Recognize only, without parse trace\n"
+           "  --trace-limit <N>    Keep only the last N parse steps (0 - all)\n"
+           "  --recover            Recover from syntax errors and report all of them\n"
+           "  --lexer <NAME>       Lexer backend: flex (default) or simd\n"
+           "  -b, --batch <PATH>   Add input file or directory to batch (repeatable);\n"
+           "                       in batch mode -o is a directory for <name>.popout results\n"
+           "  --manifest <FILE>    Add batch inputs listed in FILE, one path per line\n"
+           "  -j, --jobs <N>       Build the table and parse batch inputs in N threads (0 - all cores)\n"
+           "  -g, --grammar <FILE> Load grammar from FILE instead of the built-in one\n"
+           "  --lookahead <NAME>   Table construction: slr (default) or lalr\n"
+           "  --dump-table <FILE>  Save built parsing table to binary FILE\n"
+           "  --load-table <FILE>  Load parsing table from FILE instead of building it\n"
+           "  --runtime-table      Build parsing table at runtime instead of the compiled one\n"
+           "  --ast                Build the parse tree and print it after the result\n"
+           "  --eval               Evaluate the expression (built-in grammar only)\n"
+           "  --var <NAME=VALUE>   Bind variable NAME for --eval/--compile (repeatable)\n"
+           "  --compile            Compile the expression to bytecode and evaluate it\n"
+           "  --bindings <FILE>    With --compile, evaluate for each line of NAME=VALUE pairs in FILE\n"
+           "  --columns <FILE>     With --compile, evaluate for each row of CSV FILE (header - variable names)\n"
+           "  --cache <N>          Cache results of N distinct token sequences (0 - no cache, default)\n"
+           "  --eviction <NAME>    Cache eviction: lru (default) or fifo\n"
+           "  --edits <FILE>       After parsing, apply edits from FILE (OFFSET LENGTH TEXT per line)\n"
+           "                       and reparse incrementally after each one\n";
 }
 
 std::string_view             Args::getProgramName      () const noexcept { return program_name_; }
@@ -56,6 +269,28 @@ std::optional<std::string>   Args::getInputFilename    () const noexcept { retur
 std::optional<std::string>   Args::getOutputFilename   () const noexcept { return output_filename_; }
 bool                         Args::getHelp             () const noexcept { return help_; }
 bool                         Args::getVerbose          () const noexcept { return verbose_; }
+bool                         Args::getFast             () const noexcept { return fast_; }
+size_t                       Args::getTraceLimit       () const noexcept { return trace_limit_; }
+std::string_view             Args::getLexer            () const noexcept { return lexer_; }
+const std::vector<std::string>& Args::getBatchInputs   () const noexcept { return batch_inputs_; }
+std::optional<std::string>   Args::getManifest         () const noexcept { return manifest_; }
+bool                         Args::isBatch             () const noexcept { return !batch_inputs_.empty() || manifest_.has_value(); }
+size_t                       Args::getJobs             () const noexcept { return jobs_; }
+std::optional<std::string>   Args::getGrammar          () const noexcept { return grammar_; }
+std::optional<std::string>   Args::getLookahead        () const noexcept { return lookahead_; }
+std::optional<std::string>   Args::getDumpTable        () const noexcept { return dump_table_; }
+std::optional<std::string>   Args::getLoadTable        () const noexcept { return load_table_; }
+bool                         Args::getRuntimeTable     () const noexcept { return runtime_table_; }
+bool                         Args::getAst              () const noexcept { return ast_; }
+bool                         Args::getRecover          () const noexcept { return recover_; }
+bool                         Args::getEval             () const noexcept { return eval_; }
+const std::vector<std::string>& Args::getVariables     () const noexcept { return variables_; }
+bool                         Args::getCompile          () const noexcept { return compile_; }
+std::optional<std::string>   Args::getBindings         () const noexcept { return bindings_; }
+std::optional<std::string>   Args::getColumns          () const noexcept { return columns_; }
+size_t                       Args::getCache            () const noexcept { return cache_; }
+std::string_view             Args::getCacheEviction    () const noexcept { return cache_eviction_; }
+std::optional<std::string>   Args::getEdits            () const noexcept { return edits_; }
 
 }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "utils/common.hpp"
 #include <iostream>
+#include <iterator>
 
 namespace slr {
 namespace args {
@@ -13,25 +14,19 @@ IOManger::IOManger(
     ,   output_filename_(output_filename)
 {
     if (input_filename_.has_value()) {
-        input_file_.open(*input_filename_);
-        if (!input_file_.is_open()) {
-            utils::THROW("Can't open input file '" + *input_filename_ + "'");
-        }
+        input_file_.emplace(*input_filename_);
     }
 
     if (output_filename_.has_value()) {
         output_file_.open(*output_filename_);
         if (!output_file_.is_open()) {
-            input_file_.close();
+            input_file_.reset();
             utils::THROW("Can't open output file '" + *output_filename_ + "'");
         }
     }
 }
 
 IOManger::~IOManger() {
-    if (input_file_.is_open()) {
-        input_file_.close();
-    }
     if (output_file_.is_open()) {
         output_file_.close();
     }
@@ -39,8 +34,18 @@ IOManger::~IOManger() {
 
 std::optional<std::string> IOManger::getInputFilename    ()  const noexcept {return  input_filename_; }
 std::optional<std::string> IOManger::getOutputFilename   ()  const noexcept {return output_filename_; }
-std::istream&              IOManger::getInputFile        ()        noexcept {return  input_file_.is_open() ?  input_file_ : std::cin;  }
+std::istream&              IOManger::getInputStream      ()        noexcept {return std::cin; }
 std::ostream&              IOManger::getOutputFile       ()        noexcept {return output_file_.is_open() ? output_file_ : std::cout; }
 
+std::string_view IOManger::getInputBuffer() {
+    if (input_file_.has_value()) {
+        return input_file_->view();
+    }
+    if (!input_storage_.has_value()) {
+        input_storage_.emplace(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+    }
+    return *input_storage_;
+}
+
 }
 }
\ No newline at end of file
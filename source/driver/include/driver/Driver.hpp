@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lexer/LexerBackend.hpp"
+#include "syntaxer/ArithmeticActions.hpp"
+#include "syntaxer/Bytecode.hpp"
+#include "syntaxer/Grammar.hpp"
+#include "syntaxer/IncrementalParser.hpp"
+#include "syntaxer/ParseCache.hpp"
+#include "syntaxer/ParsingTable.hpp"
+#include "syntaxer/SemanticSyntaxer.hpp"
+#include "syntaxer/Syntaxer.hpp"
+
+namespace slr {
+namespace driver {
+
+enum class EvalMode {
+    NONE,
+    DIRECT,     // значение считается семантическими действиями прямо при разборе
+    BYTECODE    // выражение компилируется в байткод и вычисляется для каждого набора переменных
+};
+
+struct Options {
+    bool verbose = false;
+    bool fast = false;
+    size_t trace_limit = 0;
+    lexer::LexerKind lexer_kind = lexer::LexerKind::FLEX;
+    size_t jobs = 1;    // 0 - по числу ядер
+    bool ast = false;   // строить дерево разбора и печатать его после результата
+    bool recover = false;   // продолжать разбор после синтаксических ошибок
+    EvalMode eval = EvalMode::NONE;     // только встроенная грамматика
+    syntaxer::Bindings variables;
+    std::vector<syntaxer::Bindings> binding_sets;   // для BYTECODE, пусто - только variables
+    std::optional<syntaxer::Columns> columns;       // для BYTECODE вместо binding_sets, переменных нет в столбцах - из variables
+    size_t cache_capacity = 0;  // 0 - без кэша разбора
+    syntaxer::CacheEviction cache_eviction = syntaxer::CacheEviction::LRU;
+    std::vector<syntaxer::TextEdit> edits;  // не пусто - документ разбирается, затем правится и разбирается инкрементально
+};
+
+struct DocumentResult {
+    std::string name;
+    std::optional<std::string> error_message;   // первая ошибка
+    size_t error_count = 0;                     // синтаксических ошибок, найденных с восстановлением
+    std::optional<std::string> failure;         // вход не обработан: исключение, например файл не открылся
+};
+
+// Разбор документов с общими грамматикой и таблицей
+class Driver {
+
+public:
+
+    Driver(const syntaxer::Grammar& grammar, const syntaxer::ParsingTable& table, const Options& options);
+
+    // Без трассы, печати токенов и кэша разбирает прямо из лексера, не собирая вектор токенов
+    bool streams() const noexcept;
+
+    // Попадания и промахи кэша разбора, вместе с воркерами runBatch
+    syntaxer::CacheStats getCacheStats() const noexcept;
+
+    DocumentResult process(lexer::LexerBackend& lexer, std::ostream& out);
+
+    // Разбор text, затем каждой правки options.edits по очереди через IncrementalParser.
+    // Результат документа - после последней правки
+    DocumentResult processEdits(std::string_view text, std::ostream& out);
+
+    // Результат каждого входа пишется в <output_dir>/<имя>.popout, без output_dir - в out.
+    // При options.jobs != 1 входы разбираются параллельно, вывод и результаты - в порядке входов.
+    // Исключение на одном входе - его failure, остальные входы разбираются при любом jobs
+    std::vector<DocumentResult> runBatch(
+        const std::vector<std::string>& inputs, 
+        const std::optional<std::string>& output_dir,
+        std::ostream& out = std::cout
+    );
+
+    // Файлы и содержимое директорий (в порядке имён), затем строки манифеста
+    static std::vector<std::string> collectInputs(
+        const std::vector<std::string>& paths, 
+        const std::optional<std::string>& manifest
+    );
+
+    static void printSummary(const std::vector<DocumentResult>& results, std::ostream& out = std::cout);
+
+private:
+
+    // Разбор одного входа, вывод в output_dir или в out
+    DocumentResult processFile(
+        const std::string& input, 
+        const std::optional<std::string>& output_dir, 
+        std::ostream& out
+    );
+
+    // Через кэш, если он включён; ссылка действительна до следующего разбора
+    const syntaxer::ParseResult& parse(const std::vector<lexer::Token>& tokens);
+
+    // Вычисление и печать значения; ошибка вычисления - ошибка документа
+    void evaluate(lexer::TokenStream& tokens, DocumentResult& result, std::ostream& out);
+    void evaluateBytecode(lexer::TokenStream& tokens, DocumentResult& result, std::ostream& out);
+    void evaluateColumns(DocumentResult& result, std::ostream& out);
+
+    std::vector<DocumentResult> runBatchParallel(
+        const std::vector<std::string>& inputs, 
+        const std::optional<std::string>& output_dir,
+        std::ostream& out,
+        size_t jobs
+    );
+
+private:
+
+    const syntaxer::Grammar& grammar_;
+    const syntaxer::ParsingTable& table_;
+    Options options_;
+
+    syntaxer::Syntaxer syntaxer_;
+    std::optional<syntaxer::ParseCache> cache_;
+    syntaxer::ParseResult parse_result_;    // результат без кэша
+    syntaxer::CacheStats worker_cache_stats_;
+
+    using Evaluator = syntaxer::SemanticSyntaxer<syntaxer::ArithmeticActions>;
+    using Compiler  = syntaxer::SemanticSyntaxer<syntaxer::BytecodeCompiler>;
+
+    syntaxer::ArithmeticActions arithmetic_actions_;
+    std::unique_ptr<Evaluator> evaluator_;  // только при EvalMode::DIRECT
+
+    // Программа документа и стек вычисления переиспользуются между документами
+    syntaxer::Bytecode program_;
+    syntaxer::BytecodeCompiler bytecode_compiler_;
+    std::unique_ptr<Compiler> compiler_;    // только при EvalMode::BYTECODE
+
+    std::unique_ptr<syntaxer::IncrementalParser> incremental_;  // только при options.edits
+    std::vector<double> eval_stack_;
+    std::vector<std::vector<double>> constant_columns_;
+    std::vector<double> column_result_;
+};
+
+}
+}
\ No newline at end of file
@@ -0,0 +1,552 @@
+#include "driver/Driver.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include "utils/common.hpp"
+#include "utils/MappedFile.hpp"
+
+namespace slr {
+namespace driver {
+
+Driver::Driver(
+    const syntaxer::Grammar& grammar, const syntaxer::ParsingTable& table, const Options& options
+)   :   grammar_(grammar)
+    ,   table_(table)
+    ,   options_(options)
+    ,   syntaxer_(
+            grammar, 
+            table, 
+            options.fast ? syntaxer::ParseMode::RECOGNIZE : syntaxer::ParseMode::TRACE
+        )
+    ,   arithmetic_actions_(options_.variables)
+    ,   bytecode_compiler_(program_)
+{
+    syntaxer_.setTraceLimit(options_.trace_limit);
+    syntaxer_.setBuildAst(options_.ast);
+    syntaxer_.setRecover(options_.recover);
+
+    if (options_.eval != EvalMode::NONE && !grammar_.isBuiltin()) {
+        utils::THROW("Evaluation is supported only for the built-in grammar");
+    }
+    if (options_.eval == EvalMode::DIRECT) {
+        evaluator_ = std::make_unique<Evaluator>(grammar_, table_, arithmetic_actions_);
+    }
+    if (options_.eval == EvalMode::BYTECODE) {
+        compiler_ = std::make_unique<Compiler>(grammar_, table_, bytecode_compiler_);
+    }
+    if (options_.cache_capacity != 0) {
+        cache_.emplace(options_.cache_capacity, options_.cache_eviction);
+    }
+    if (!options_.edits.empty()) {
+        incremental_ = std::make_unique<syntaxer::IncrementalParser>(grammar_, table_, options_.lexer_kind);
+    }
+}
+
+bool Driver::streams() const noexcept {
+    return options_.fast && !options_.verbose && !cache_.has_value();
+}
+
+syntaxer::CacheStats Driver::getCacheStats() const noexcept {
+    syntaxer::CacheStats stats = worker_cache_stats_;
+    if (cache_.has_value()) {
+        stats.hits += cache_->getStats().hits;
+        stats.misses += cache_->getStats().misses;
+    }
+    return stats;
+}
+
+const syntaxer::ParseResult& Driver::parse(const std::vector<lexer::Token>& tokens) {
+    if (!cache_.has_value()) {
+        parse_result_ = syntaxer_.parse(tokens);
+        return parse_result_;
+    }
+    return cache_->parse(tokens, [&] { return syntaxer_.parse(tokens); });
+}
+
+DocumentResult Driver::process(lexer::LexerBackend& lexer, std::ostream& out) {
+    if (options_.verbose) {
+        grammar_.print(out);
+        table_.print(out);
+    }
+
+    // при потоковом разборе вход читается один раз, поэтому разбирает только вычислитель
+    if (streams() && options_.eval != EvalMode::NONE) {
+        DocumentResult result;
+        evaluate(lexer, result, out);
+        return result;
+    }
+
+    if (streams()) {
+        const auto parse_result = syntaxer_.parse(lexer);
+        syntaxer_.print(parse_result, {}, out);
+        if (options_.ast) {
+            parse_result.ast.print(grammar_, out);
+        }
+        return {{}, parse_result.error_message, parse_result.diagnostics.size(), {}};
+    }
+
+    const auto& tokens = lexer.parse();
+
+    if (options_.verbose) {
+        lexer.print(out);
+    }
+
+    const auto& parse_result = parse(tokens);
+
+    if (options_.verbose) {
+        syntaxer_.print(parse_result, tokens, out);
+    }
+    if (options_.ast) {
+        parse_result.ast.print(grammar_, out);
+    }
+
+    DocumentResult result{{}, parse_result.error_message, parse_result.diagnostics.size(), {}};
+
+    if (options_.eval != EvalMode::NONE && !result.error_message.has_value()) {
+        lexer::VectorTokenStream stream(tokens);
+        evaluate(stream, result, out);
+    }
+
+    return result;
+}
+
+namespace {
+
+// Текст правки в одну строку
+std::string escapeText(std::string_view text) {
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+            case '\n':  escaped += "\\n";   break;
+            case '\t':  escaped += "\\t";   break;
+            case '\\':  escaped += "\\\\";  break;
+            case '"':   escaped += "\\\"";  break;
+            default:    escaped += c;       break;
+        }
+    }
+    return escaped;
+}
+
+void printIncremental(const syntaxer::IncrementalResult& result, std::ostream& out) {
+    if (result.error_message.has_value()) {
+        out << "ERROR (" << *result.error_message << ")";
+    }
+    else {
+        out << "SUCCESSFULLY";
+    }
+    out << "; relexed " << result.relexed_tokens << ", reparsed " << result.reparsed_tokens << " tokens\n";
+}
+
+}
+
+DocumentResult Driver::processEdits(std::string_view text, std::ostream& out) {
+    if (options_.verbose) {
+        grammar_.print(out);
+        table_.print(out);
+    }
+
+    out << "\n===Incremental===\n";
+    out << "Initial: ";
+    printIncremental(incremental_->reset(std::string(text)), out);
+
+    for (size_t edit_ind = 0; edit_ind < options_.edits.size(); ++edit_ind) {
+        const syntaxer::TextEdit& edit = options_.edits[edit_ind];
+        out << "Edit " << edit_ind + 1 << " [" << edit.begin << ", " << edit.begin + edit.length << ") -> \""
+            << escapeText(edit.replacement) << "\": ";
+        printIncremental(incremental_->edit(edit), out);
+    }
+
+    const auto& result = incremental_->getResult();
+    return {{}, result.error_message, result.error_message.has_value() ? size_t{1} : size_t{0}, {}};
+}
+
+void Driver::evaluate(lexer::TokenStream& tokens, DocumentResult& result, std::ostream& out) {
+    if (compiler_) {
+        evaluateBytecode(tokens, result, out);
+        return;
+    }
+
+    const auto eval_result = evaluator_->parse(tokens);
+
+    out << "\n===Evaluation===\n";
+    if (eval_result.value.has_value()) {
+        out << "Value: " << *eval_result.value << "\n";
+    }
+    else {
+        out << "ERROR\n" << "Message: " << *eval_result.error_message << "\n";
+        result.error_message = eval_result.error_message;
+    }
+}
+
+void Driver::evaluateBytecode(lexer::TokenStream& tokens, DocumentResult& result, std::ostream& out) {
+    auto fail = [&](const std::string& message) {
+        out << "ERROR\n" << "Message: " << message << "\n";
+        result.error_message = message;
+    };
+
+    program_.clear();
+    const auto compile_result = compiler_->parse(tokens);
+
+    if (!compile_result.value.has_value()) {
+        out << "\n===Evaluation===\n";
+        fail(*compile_result.error_message);
+        return;
+    }
+
+    bytecode_compiler_.finish(*compile_result.value);
+    program_.print(out);
+
+    out << "\n===Evaluation===\n";
+
+    if (options_.columns.has_value()) {
+        evaluateColumns(result, out);
+        return;
+    }
+
+    // программа компилируется один раз и вычисляется для каждого набора переменных
+    const std::span<const syntaxer::Bindings> binding_sets = options_.binding_sets.empty()
+        ?   std::span<const syntaxer::Bindings>(&options_.variables, 1)
+        :   std::span<const syntaxer::Bindings>(options_.binding_sets);
+
+    for (const auto& bindings : binding_sets) {
+        const auto values = program_.bind(bindings);
+
+        if (!values.has_value()) {
+            const auto& names = program_.getVariableNames();
+            for (uint32_t slot = 0; slot < names.size(); ++slot) {
+                if (!bindings.contains(names[slot])) {
+                    fail(
+                        "Semantic error in line " + std::to_string(program_.getVariableLine(slot))
+                        + ", token " + names[slot] + " has no value"
+                    );
+                    return;
+                }
+            }
+        }
+
+        out << "Value: " << program_.evaluate(*values, eval_stack_) << "\n";
+    }
+}
+
+void Driver::evaluateColumns(DocumentResult& result, std::ostream& out) {
+    const syntaxer::Columns& columns = *options_.columns;
+    const auto& names = program_.getVariableNames();
+
+    // переменная без столбца, но с --var - столбец из одного значения
+    std::vector<std::span<const double>> slot_columns;
+    constant_columns_.clear();
+    constant_columns_.reserve(names.size());
+
+    for (uint32_t slot = 0; slot < names.size(); ++slot) {
+        if (const auto* column = columns.find(names[slot])) {
+            slot_columns.emplace_back(*column);
+            continue;
+        }
+
+        const auto variable = options_.variables.find(names[slot]);
+        if (variable == options_.variables.end()) {
+            const std::string message = 
+                "Semantic error in line " + std::to_string(program_.getVariableLine(slot))
+                + ", token " + names[slot] + " has no value";
+            out << "ERROR\n" << "Message: " << message << "\n";
+            result.error_message = message;
+            return;
+        }
+        constant_columns_.emplace_back(columns.row_count, variable->second);
+        slot_columns.emplace_back(constant_columns_.back());
+    }
+
+    column_result_.resize(columns.row_count);
+    program_.evaluateColumns(slot_columns, column_result_, eval_stack_);
+
+    for (double value : column_result_) {
+        out << "Value: " << value << "\n";
+    }
+}
+
+namespace {
+
+// Отчёт входа в пакетном режиме
+std::filesystem::path reportPath(const std::string& input, const std::string& output_dir) {
+    return std::filesystem::path(output_dir) / (std::filesystem::path(input).stem().string() + ".popout");
+}
+
+// Очередь индексов входов на каждого воркера: свои задачи берутся с начала, 
+// чужие крадутся с конца
+class WorkStealingQueues {
+
+public:
+
+    WorkStealingQueues(size_t task_count, size_t worker_count) 
+        :   queues_(worker_count)
+    {
+        // непрерывные куски, чтобы соседние файлы обрабатывал один воркер
+        const size_t chunk = (task_count + worker_count - 1) / worker_count;
+        for (size_t task = 0; task < task_count; ++task) {
+            queues_[task / chunk].tasks.push_back(task);
+        }
+    }
+
+    std::optional<size_t> pop(size_t worker) {
+        {
+            Queue& own = queues_[worker];
+            std::lock_guard lock(own.mutex);
+            if (!own.tasks.empty()) {
+                const size_t task = own.tasks.front();
+                own.tasks.pop_front();
+                return task;
+            }
+        }
+
+        for (size_t shift = 1; shift < queues_.size(); ++shift) {
+            Queue& victim = queues_[(worker + shift) % queues_.size()];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                const size_t task = victim.tasks.back();
+                victim.tasks.pop_back();
+                return task;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+private:
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    std::deque<Queue> queues_;
+};
+
+}
+
+DocumentResult Driver::processFile(
+    const std::string& input, 
+    const std::optional<std::string>& output_dir, 
+    std::ostream& out
+) {
+    namespace fs = std::filesystem;
+
+    // исключение - результат этого входа: остальные разбираются одинаково при -j 1 и -j N
+    try {
+        utils::MappedFile input_file(input);
+
+        std::ofstream output_file;
+        if (output_dir.has_value()) {
+            const fs::path output_path = reportPath(input, *output_dir);
+            output_file.open(output_path);
+            if (!output_file.is_open()) {
+                utils::THROW("Can't open output file '" + output_path.string() + "'");
+            }
+        }
+        else {
+            out << "\n=== " << input << " ===\n";
+        }
+        std::ostream& doc_out = output_dir.has_value() ? output_file : out;
+
+        auto lexer = lexer::makeLexer(options_.lexer_kind, input_file.view(), &doc_out);
+
+        DocumentResult result = incremental_ ? processEdits(input_file.view(), doc_out) : process(*lexer, doc_out);
+        result.name = input;
+        return result;
+    }
+    catch (const std::exception& e) {
+        return {input, {}, 0, e.what()};
+    }
+}
+
+std::vector<DocumentResult> Driver::runBatch(
+    const std::vector<std::string>& inputs, 
+    const std::optional<std::string>& output_dir,
+    std::ostream& out
+) {
+    // Отчёты называются по имени входа без директории: входы с одним именем перезаписали бы
+    // отчёт друг друга, а с -j писали бы в один файл одновременно. Проверяется до запуска воркеров
+    if (output_dir.has_value()) {
+        std::unordered_map<std::string, const std::string*> report_owners;
+        for (const auto& input : inputs) {
+            const std::string report = reportPath(input, *output_dir).string();
+            const auto [owner, inserted] = report_owners.try_emplace(report, &input);
+            if (!inserted) {
+                utils::THROW("Inputs '" + *owner->second + "' and '" + input + "' both write '" + report + "'");
+            }
+        }
+
+        std::filesystem::create_directories(*output_dir);
+    }
+
+    const size_t jobs = std::min(
+        options_.jobs != 0 ? options_.jobs : std::max<size_t>(std::thread::hardware_concurrency(), 1),
+        std::max<size_t>(inputs.size(), 1)
+    );
+
+    if (jobs > 1) {
+        return runBatchParallel(inputs, output_dir, out, jobs);
+    }
+
+    std::vector<DocumentResult> results;
+    results.reserve(inputs.size());
+
+    for (const auto& input : inputs) {
+        results.push_back(processFile(input, output_dir, out));
+    }
+
+    return results;
+}
+
+std::vector<DocumentResult> Driver::runBatchParallel(
+    const std::vector<std::string>& inputs, 
+    const std::optional<std::string>& output_dir,
+    std::ostream& out,
+    size_t jobs
+) {
+    std::vector<DocumentResult> results(inputs.size());
+    WorkStealingQueues queues(inputs.size(), jobs);
+
+    // без output_dir вывод документов буферизуется и сбрасывается в out строго по порядку
+    std::mutex out_mutex;
+    std::vector<std::optional<std::string>> pending(output_dir.has_value() ? 0 : inputs.size());
+    size_t next_to_flush = 0;
+
+    std::mutex error_mutex;
+    std::exception_ptr first_error;
+
+    std::mutex stats_mutex;
+
+    auto worker = [&](size_t worker_ind) {
+        // у каждого воркера свои стеки разбора, таблица и грамматика общие
+        Driver worker_driver(grammar_, table_, options_);
+
+        try {
+            while (auto task = queues.pop(worker_ind)) {
+                if (output_dir.has_value()) {
+                    results[*task] = worker_driver.processFile(inputs[*task], output_dir, out);
+                    continue;
+                }
+
+                std::ostringstream doc_out;
+                results[*task] = worker_driver.processFile(inputs[*task], output_dir, doc_out);
+
+                std::lock_guard lock(out_mutex);
+                pending[*task] = std::move(doc_out).str();
+                while (next_to_flush < pending.size() && pending[next_to_flush].has_value()) {
+                    out << *pending[next_to_flush];
+                    pending[next_to_flush].reset();
+                    ++next_to_flush;
+                }
+            }
+        }
+        catch (...) {
+            std::lock_guard lock(error_mutex);
+            if (!first_error) {
+                first_error = std::current_exception();
+            }
+        }
+
+        // кэш у каждого воркера свой, счётчики собираются в основной Driver
+        const syntaxer::CacheStats stats = worker_driver.getCacheStats();
+        std::lock_guard lock(stats_mutex);
+        worker_cache_stats_.hits += stats.hits;
+        worker_cache_stats_.misses += stats.misses;
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(jobs);
+    for (size_t worker_ind = 0; worker_ind < jobs; ++worker_ind) {
+        workers.emplace_back(worker, worker_ind);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    if (first_error) {
+        std::rethrow_exception(first_error);
+    }
+
+    return results;
+}
+
+std::vector<std::string> Driver::collectInputs(
+    const std::vector<std::string>& paths, 
+    const std::optional<std::string>& manifest
+) {
+    namespace fs = std::filesystem;
+
+    std::vector<std::string> inputs;
+
+    for (const auto& path : paths) {
+        if (!fs::is_directory(path)) {
+            inputs.push_back(path);
+            continue;
+        }
+
+        std::vector<std::string> dir_inputs;
+        for (const auto& entry : fs::directory_iterator(path)) {
+            if (entry.is_regular_file()) {
+                dir_inputs.push_back(entry.path().string());
+            }
+        }
+        std::sort(dir_inputs.begin(), dir_inputs.end());
+        inputs.insert(inputs.end(), dir_inputs.begin(), dir_inputs.end());
+    }
+
+    if (manifest.has_value()) {
+        std::ifstream manifest_file(*manifest);
+        if (!manifest_file.is_open()) {
+            utils::THROW("Can't open manifest file '" + *manifest + "'");
+        }
+
+        // пустые строки и строки с '#' пропускаются, относительные пути - от манифеста
+        const fs::path manifest_dir = fs::path(*manifest).parent_path();
+        std::string line;
+        while (std::getline(manifest_file, line)) {
+            if (line.empty() || line.front() == '#') {
+                continue;
+            }
+            const fs::path input_path(line);
+            inputs.push_back((input_path.is_absolute() ? input_path : manifest_dir / input_path).string());
+        }
+    }
+
+    return inputs;
+}
+
+void Driver::printSummary(const std::vector<DocumentResult>& results, std::ostream& out) {
+    size_t failed = 0;
+
+    for (const auto& result : results) {
+        out << result.name << ": ";
+        if (result.failure.has_value()) {
+            out << "FAILED\n";
+            ++failed;
+        }
+        else if (result.error_message.has_value() && result.error_count > 1) {
+            out << "ERROR (" << *result.error_message << "; " << result.error_count << " errors)\n";
+            ++failed;
+        }
+        else if (result.error_message.has_value()) {
+            out << "ERROR (" << *result.error_message << ")\n";
+            ++failed;
+        }
+        else {
+            out << "OK\n";
+        }
+    }
+
+    out << "Total: " << results.size() << ", errors: " << failed << "\n";
+}
+
+}
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <string_view>
 #include <vector>
 
 #if !defined(yyFlexLexerOnce)
@@ -8,21 +9,26 @@
 #endif
 
 #include "lexer/tokens.hpp"
+#include "lexer/LexerBackend.hpp"
 
 namespace slr {
 namespace lexer {
 
-class Lexer : public yyFlexLexer {
+class Lexer : public yyFlexLexer, public LexerBackend {
 
 public:
 
-    Lexer(std::istream* in = nullptr, std::ostream* out = nullptr);
-    
-    static std::string getTokenTypeStr(TokenType token);
+    // input должен жить дольше лексера и полученных из него токенов, first_line - номер его первой строки
+    explicit Lexer(std::string_view input, std::ostream* out = nullptr, int first_line = 1);
 
-    const std::vector<Token>& parse();
+    // Потоковый режим: Token::value действителен только до следующего next()
+    explicit Lexer(std::istream* in, std::ostream* out = nullptr);
 
-    void print(std::ostream& out = std::cout) const;
+    const Token& next() override;
+
+protected:
+
+    bool hasPersistentTokens() const noexcept override;
 
 private:
 
@@ -30,11 +36,21 @@ private:
 
     virtual int yylex() override;
 
+    virtual int LexerInput(char* buf, int max_size) override;
+
+    std::string_view lexeme() const noexcept;
+
 private:
 
-    Token token_;
+    std::string_view input_;
+    size_t read_pos_ = 0;
+    bool from_stream_ = false;
+
+    // смещение текущей лексемы во входе, обновляется в YY_USER_ACTION
+    size_t lexeme_begin_ = 0;
+    size_t lexeme_end_ = 0;
 
-    std::vector<Token> tokens_;
+    Token token_;
 
 };
 
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lexer/tokens.hpp"
+#include "lexer/TokenStream.hpp"
+
+namespace slr {
+namespace lexer {
+
+enum class LexerKind {
+    FLEX,
+    SIMD
+};
+
+// Общая часть реализаций лексера: сбор всех токенов в вектор и их печать
+class LexerBackend : public TokenStream {
+
+public:
+
+    static std::string              getTokenTypeStr (TokenType token);
+    static std::optional<LexerKind> kindFromStr     (std::string_view name) noexcept;
+
+    const std::vector<Token>& parse();
+
+    void print(std::ostream& out = std::cout) const;
+
+protected:
+
+    // false, если Token::value живёт только до следующего next()
+    virtual bool hasPersistentTokens() const noexcept { return true; }
+
+private:
+
+    std::vector<Token> tokens_;
+};
+
+// input должен жить дольше лексера и полученных из него токенов.
+// first_line - номер строки начала input, если это кусок большего текста
+std::unique_ptr<LexerBackend> makeLexer(
+    LexerKind kind, std::string_view input, std::ostream* out = nullptr, int first_line = 1
+);
+
+}
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string_view>
+
+#include "lexer/tokens.hpp"
+#include "lexer/LexerBackend.hpp"
+
+namespace slr {
+namespace lexer {
+
+// Рукописный лексер по непрерывному буферу. Пропуск пробелов и хвосты чисел/идентификаторов
+// сканируются векторно (AVX2/SSE2, иначе скалярно). Выдаёт тот же поток токенов, что и flex-лексер.
+class SimdLexer : public LexerBackend {
+
+public:
+
+    // input должен жить дольше лексера и полученных из него токенов, first_line - номер его первой строки
+    explicit SimdLexer(std::string_view input, int first_line = 1) noexcept;
+
+    const Token& next() override;
+
+private:
+
+    std::string_view input_;
+    size_t pos_ = 0;
+    int line_ = 1;
+
+    Token token_;
+};
+
+}
+}
\ No newline at end of file
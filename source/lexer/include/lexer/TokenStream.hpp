@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include "lexer/tokens.hpp"
+
+namespace slr {
+namespace lexer {
+
+// Источник токенов для синтаксического анализатора. 
+// После END_OF_FILE продолжает возвращать END_OF_FILE.
+class TokenStream {
+
+public:
+
+    virtual ~TokenStream() = default;
+
+    // Ссылка действительна до следующего вызова next()
+    virtual const Token& next() = 0;
+};
+
+class VectorTokenStream : public TokenStream {
+
+public:
+
+    explicit VectorTokenStream(const std::vector<Token>& tokens) noexcept
+        :   tokens_(tokens)
+    {}
+
+    const Token& next() override {
+        const Token& token = tokens_[pos_];
+        if (pos_ + 1 < tokens_.size()) {
+            ++pos_;
+        }
+        return token;
+    }
+
+private:
+
+    const std::vector<Token>& tokens_;
+    size_t pos_ = 0;
+};
+
+}
+}
\ No newline at end of file
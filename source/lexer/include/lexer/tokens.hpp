@@ -2,6 +2,7 @@
 
 #include <concepts>
 #include <string>
+#include <string_view>
 
 namespace slr {
 namespace lexer {
@@ -23,15 +24,16 @@ enum class TokenType: int {
     COUNT
 };
 
+// value ссылается на входной буфер лексера и не владеет памятью
 struct Token {
 
     TokenType type = TokenType::UNKNOWN;
-    std::string value = "";
+    std::string_view value = "";
     int line = -1;
 
     Token() = default;
 
-    Token(TokenType type, std::string value, int line)
+    Token(TokenType type, std::string_view value, int line)
         :   type(type)
         ,   value(value)
         ,   line(line)
@@ -1,64 +1,57 @@
 #include "lexer/Lexer.hpp"
 
 #include "lexer/tokens.hpp"
-#include <iomanip>
+#include <algorithm>
+#include <cstring>
 
 namespace slr {
 namespace lexer {
 
+Lexer::Lexer(std::string_view input, std::ostream* out, int first_line) 
+    :   yyFlexLexer(nullptr, out)
+    ,   input_(input)
+{
+    yylineno = first_line;
+}
+
 Lexer::Lexer(std::istream* in, std::ostream* out) 
     :   yyFlexLexer(in, out)
+    ,   from_stream_(true)
 {}
 
-const Token& Lexer::getToken() { 
-    yylex();
-    return token_; 
-}
-
-const std::vector<Token>& Lexer::parse() {
-
-    Token token;
-    while ((token = getToken()).type != slr::lexer::TokenType::END_OF_FILE) {
-        tokens_.push_back(std::move(token));
+int Lexer::LexerInput(char* buf, int max_size) {
+    if (from_stream_) {
+        return yyFlexLexer::LexerInput(buf, max_size);
     }
-    tokens_.push_back(std::move(token));
 
-    return tokens_;
+    const size_t chunk = std::min(static_cast<size_t>(max_size), input_.size() - read_pos_);
+    std::memcpy(buf, input_.data() + read_pos_, chunk);
+    read_pos_ += chunk;
+    return static_cast<int>(chunk);
 }
 
-void Lexer::print(std::ostream& out) const {
-    out << "\n=== Lexer ===\n";
-    out << std::left << std::setw(30) << "TYPE" << "VALUE" << "\n";
-    out << std::string(30, '-') << "\n";
-    
-    for (const auto& token : tokens_) {
-        out << std::left << std::setw(30) 
-            << Lexer::getTokenTypeStr(token.type) << token.value << "\n";
+std::string_view Lexer::lexeme() const noexcept {
+    if (from_stream_) {
+        return {yytext, static_cast<size_t>(yyleng)};
     }
-    
-    out << std::string(30, '-') << "\n";
-    out << "Total tokens: " << tokens_.size() << "\n";
+    return input_.substr(lexeme_begin_, lexeme_end_ - lexeme_begin_);
 }
 
-#define CASE_RET_STR(type) case TokenType::type: { return #type; }
-std::string Lexer::getTokenTypeStr(TokenType tt) {
-    switch (tt) {
-        CASE_RET_STR(END_OF_FILE)
-        CASE_RET_STR(PLUS)
-        CASE_RET_STR(MINUS)
-        CASE_RET_STR(MUL)
-        CASE_RET_STR(DIV)
-        CASE_RET_STR(LBRACKET)
-        CASE_RET_STR(RBRACKET)
-        CASE_RET_STR(ID)
-        CASE_RET_STR(NUMBER)
-        default: {
-            return "UNKNOWN";
-        }
+const Token& Lexer::next() {
+    if (token_.type == TokenType::END_OF_FILE) {
+        return token_;
     }
-    return "UNKNOWN";
+    return getToken();
+}
+
+const Token& Lexer::getToken() { 
+    yylex();
+    return token_; 
+}
+
+bool Lexer::hasPersistentTokens() const noexcept {
+    return !from_stream_;
 }
-#undef CASE_RET_STR
 
 }
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "lexer/LexerBackend.hpp"
+
+#include "lexer/Lexer.hpp"
+#include "lexer/SimdLexer.hpp"
+#include "utils/common.hpp"
+#include <iomanip>
+
+namespace slr {
+namespace lexer {
+
+const std::vector<Token>& LexerBackend::parse() {
+    if (!hasPersistentTokens()) {
+        utils::THROW("Lexer::parse() needs a buffered input, stream tokens are not persistent");
+    }
+
+    Token token;
+    while ((token = next()).type != slr::lexer::TokenType::END_OF_FILE) {
+        tokens_.push_back(std::move(token));
+    }
+    tokens_.push_back(std::move(token));
+
+    return tokens_;
+}
+
+void LexerBackend::print(std::ostream& out) const {
+    out << "\n=== Lexer ===\n";
+    out << std::left << std::setw(30) << "TYPE" << "VALUE" << "\n";
+    out << std::string(30, '-') << "\n";
+    
+    for (const auto& token : tokens_) {
+        out << std::left << std::setw(30) 
+            << LexerBackend::getTokenTypeStr(token.type) << token.value << "\n";
+    }
+    
+    out << std::string(30, '-') << "\n";
+    out << "Total tokens: " << tokens_.size() << "\n";
+}
+
+#define CASE_RET_STR(type) case TokenType::type: { return #type; }
+std::string LexerBackend::getTokenTypeStr(TokenType tt) {
+    switch (tt) {
+        CASE_RET_STR(END_OF_FILE)
+        CASE_RET_STR(PLUS)
+        CASE_RET_STR(MINUS)
+        CASE_RET_STR(MUL)
+        CASE_RET_STR(DIV)
+        CASE_RET_STR(LBRACKET)
+        CASE_RET_STR(RBRACKET)
+        CASE_RET_STR(ID)
+        CASE_RET_STR(NUMBER)
+        default: {
+            return "UNKNOWN";
+        }
+    }
+    return "UNKNOWN";
+}
+#undef CASE_RET_STR
+
+std::optional<LexerKind> LexerBackend::kindFromStr(std::string_view name) noexcept {
+    if (name == "flex") {
+        return LexerKind::FLEX;
+    }
+    if (name == "simd") {
+        return LexerKind::SIMD;
+    }
+    return std::nullopt;
+}
+
+std::unique_ptr<LexerBackend> makeLexer(LexerKind kind, std::string_view input, std::ostream* out, int first_line) {
+    switch (kind) {
+        case LexerKind::FLEX:
+            return std::make_unique<Lexer>(input, out, first_line);
+        case LexerKind::SIMD:
+            return std::make_unique<SimdLexer>(input, first_line);
+    }
+    return nullptr;
+}
+
+}
+}
\ No newline at end of file
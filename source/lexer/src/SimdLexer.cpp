@@ -0,0 +1,240 @@
+#include "lexer/SimdLexer.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <iostream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace slr {
+namespace lexer {
+
+namespace {
+
+enum class CharClass : uint8_t {
+    OTHER = 0,
+    SPACE,
+    NEWLINE,
+    DIGIT,
+    ALPHA,      // [a-zA-Z_]
+    OPERATOR
+};
+
+constexpr std::array<CharClass, 256> CHAR_CLASS = [] {
+    std::array<CharClass, 256> table{};
+
+    table[static_cast<unsigned char>(' ')]  = CharClass::SPACE;
+    table[static_cast<unsigned char>('\t')] = CharClass::SPACE;
+    table[static_cast<unsigned char>('\n')] = CharClass::NEWLINE;
+
+    for (char c = '0'; c <= '9'; ++c) { table[static_cast<unsigned char>(c)] = CharClass::DIGIT; }
+    for (char c = 'a'; c <= 'z'; ++c) { table[static_cast<unsigned char>(c)] = CharClass::ALPHA; }
+    for (char c = 'A'; c <= 'Z'; ++c) { table[static_cast<unsigned char>(c)] = CharClass::ALPHA; }
+    table[static_cast<unsigned char>('_')] = CharClass::ALPHA;
+
+    for (char c : {'+', '-', '*', '/', '(', ')'}) { table[static_cast<unsigned char>(c)] = CharClass::OPERATOR; }
+
+    return table;
+}();
+
+constexpr CharClass charClass(char c) noexcept {
+    return CHAR_CLASS[static_cast<unsigned char>(c)];
+}
+
+constexpr bool isIdentTail(char c) noexcept {
+    const CharClass cc = charClass(c);
+    return cc == CharClass::ALPHA || cc == CharClass::DIGIT;
+}
+
+#if defined(__AVX2__)
+
+struct Vec {
+    using Reg  = __m256i;
+    using Mask = uint32_t;
+    constexpr inline static size_t WIDTH = 32;
+
+    static Reg  load (const char* p)        noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static Reg  set1 (char c)               noexcept { return _mm256_set1_epi8(c); }
+    static Reg  eq   (Reg a, Reg b)         noexcept { return _mm256_cmpeq_epi8(a, b); }
+    static Reg  gt   (Reg a, Reg b)         noexcept { return _mm256_cmpgt_epi8(a, b); }
+    static Reg  bor  (Reg a, Reg b)         noexcept { return _mm256_or_si256(a, b); }
+    static Reg  band (Reg a, Reg b)         noexcept { return _mm256_and_si256(a, b); }
+    static Mask mask (Reg a)                noexcept { return static_cast<Mask>(_mm256_movemask_epi8(a)); }
+};
+
+#elif defined(__SSE2__)
+
+struct Vec {
+    using Reg  = __m128i;
+    using Mask = uint32_t;
+    constexpr inline static size_t WIDTH = 16;
+
+    static Reg  load (const char* p)        noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static Reg  set1 (char c)               noexcept { return _mm_set1_epi8(c); }
+    static Reg  eq   (Reg a, Reg b)         noexcept { return _mm_cmpeq_epi8(a, b); }
+    static Reg  gt   (Reg a, Reg b)         noexcept { return _mm_cmpgt_epi8(a, b); }
+    static Reg  bor  (Reg a, Reg b)         noexcept { return _mm_or_si128(a, b); }
+    static Reg  band (Reg a, Reg b)         noexcept { return _mm_and_si128(a, b); }
+    static Mask mask (Reg a)                noexcept { return static_cast<Mask>(_mm_movemask_epi8(a)); }
+};
+
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+constexpr Vec::Mask FULL_MASK = static_cast<Vec::Mask>((uint64_t{1} << Vec::WIDTH) - 1);
+
+// lo <= c <= hi для ASCII-диапазонов (байты >= 0x80 отрицательны и в диапазон не попадают)
+inline Vec::Reg inRange(Vec::Reg chunk, char lo, char hi) noexcept {
+    return Vec::band(
+        Vec::gt(chunk, Vec::set1(static_cast<char>(lo - 1))), 
+        Vec::gt(Vec::set1(static_cast<char>(hi + 1)), chunk)
+    );
+}
+
+#endif
+
+const char* skipSpaces(const char* p, const char* end, int& line) noexcept {
+#if defined(__AVX2__) || defined(__SSE2__)
+    while (static_cast<size_t>(end - p) >= Vec::WIDTH) {
+        const Vec::Reg chunk = Vec::load(p);
+        const Vec::Mask newlines = Vec::mask(Vec::eq(chunk, Vec::set1('\n')));
+        const Vec::Mask spaces = newlines | Vec::mask(Vec::bor(
+            Vec::eq(chunk, Vec::set1(' ')), 
+            Vec::eq(chunk, Vec::set1('\t'))
+        ));
+
+        if (spaces != FULL_MASK) {
+            const int skip = std::countr_zero(static_cast<Vec::Mask>(~spaces));
+            line += std::popcount(newlines & ((Vec::Mask{1} << skip) - 1));
+            return p + skip;
+        }
+        line += std::popcount(newlines);
+        p += Vec::WIDTH;
+    }
+#endif
+    for (; p != end; ++p) {
+        const CharClass cc = charClass(*p);
+        if (cc == CharClass::NEWLINE) {
+            ++line;
+        }
+        else if (cc != CharClass::SPACE) {
+            break;
+        }
+    }
+    return p;
+}
+
+const char* skipDigits(const char* p, const char* end) noexcept {
+#if defined(__AVX2__) || defined(__SSE2__)
+    while (static_cast<size_t>(end - p) >= Vec::WIDTH) {
+        const Vec::Mask digits = Vec::mask(inRange(Vec::load(p), '0', '9'));
+        if (digits != FULL_MASK) {
+            return p + std::countr_zero(static_cast<Vec::Mask>(~digits));
+        }
+        p += Vec::WIDTH;
+    }
+#endif
+    while (p != end && charClass(*p) == CharClass::DIGIT) {
+        ++p;
+    }
+    return p;
+}
+
+const char* skipIdentTail(const char* p, const char* end) noexcept {
+#if defined(__AVX2__) || defined(__SSE2__)
+    while (static_cast<size_t>(end - p) >= Vec::WIDTH) {
+        const Vec::Reg chunk = Vec::load(p);
+        const Vec::Mask ident = Vec::mask(Vec::bor(
+            Vec::bor(inRange(chunk, 'a', 'z'), inRange(chunk, 'A', 'Z')),
+            Vec::bor(inRange(chunk, '0', '9'), Vec::eq(chunk, Vec::set1('_')))
+        ));
+        if (ident != FULL_MASK) {
+            return p + std::countr_zero(static_cast<Vec::Mask>(~ident));
+        }
+        p += Vec::WIDTH;
+    }
+#endif
+    while (p != end && isIdentTail(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+TokenType operatorType(char c) noexcept {
+    switch (c) {
+        case '+': return TokenType::PLUS;
+        case '-': return TokenType::MINUS;
+        case '*': return TokenType::MUL;
+        case '/': return TokenType::DIV;
+        case '(': return TokenType::LBRACKET;
+        case ')': return TokenType::RBRACKET;
+        default:  return TokenType::UNKNOWN;
+    }
+}
+
+}
+
+SimdLexer::SimdLexer(std::string_view input, int first_line) noexcept
+    :   input_(input)
+    ,   line_(first_line)
+{}
+
+const Token& SimdLexer::next() {
+    const char* const begin = input_.data();
+    const char* const end = begin + input_.size();
+
+    const char* p = skipSpaces(begin + pos_, end, line_);
+
+    if (p == end) {
+        pos_ = input_.size();
+        token_ = {TokenType::END_OF_FILE, "$", line_};
+        return token_;
+    }
+
+    const char* const start = p;
+    TokenType type = TokenType::UNKNOWN;
+
+    switch (charClass(*p)) {
+        case CharClass::DIGIT: {
+            type = TokenType::NUMBER;
+            p = skipDigits(p + 1, end);
+            if (end - p >= 2 && p[0] == '.' && charClass(p[1]) == CharClass::DIGIT) {
+                p = skipDigits(p + 2, end);
+            }
+            break;
+        }
+
+        case CharClass::ALPHA: {
+            type = TokenType::ID;
+            p = skipIdentTail(p + 1, end);
+            break;
+        }
+
+        case CharClass::OPERATOR: {
+            type = operatorType(*p);
+            ++p;
+            break;
+        }
+
+        default: {
+            ++p;
+            std::cerr << "Lexical error at line " << line_ 
+                << ": unexpected character '" << *start << "'" << std::endl;
+            break;
+        }
+    }
+
+    pos_ = static_cast<size_t>(p - begin);
+    token_ = {type, {start, static_cast<size_t>(p - start)}, line_};
+
+    return token_;
+}
+
+}
+}
\ No newline at end of file
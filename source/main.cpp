@@ -1,15 +1,164 @@
+#include <charconv>
 #include <cstdlib>
 #include <exception>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <cassert>
 
 #include "args/IOManager.hpp"
 #include "args/Args.hpp"
+#include "driver/Driver.hpp"
 #include "syntaxer/Grammar.hpp"
+#include "syntaxer/ParseCache.hpp"
 #include "syntaxer/ParsingTable.hpp"
 #include "syntaxer/Syntaxer.hpp"
 #include "utils/concole.hpp"
 #include "lexer/Lexer.hpp"
+#include "lexer/LexerBackend.hpp"
+#include "utils/common.hpp"
+
+namespace {
+
+// NAME=VALUE
+void addBinding(const std::string& binding, slr::syntaxer::Bindings& bindings) {
+    const size_t eq_pos = binding.find('=');
+    double value = 0;
+    const char* value_end = binding.data() + binding.size();
+
+    if (eq_pos == std::string::npos || eq_pos == 0
+        || std::from_chars(binding.data() + eq_pos + 1, value_end, value).ptr != value_end) {
+        slr::utils::THROW("Bad variable '" + binding + "', expected NAME=VALUE");
+    }
+    bindings[binding.substr(0, eq_pos)] = value;
+}
+
+// Строка файла - набор NAME=VALUE через пробелы поверх base; пустые строки и строки с '#' пропускаются
+std::vector<slr::syntaxer::Bindings> readBindingSets(const std::string& filename, const slr::syntaxer::Bindings& base) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        slr::utils::THROW("Can't open bindings file '" + filename + "'");
+    }
+
+    std::vector<slr::syntaxer::Bindings> binding_sets;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+
+        slr::syntaxer::Bindings bindings = base;
+        std::istringstream line_stream(line);
+        std::string binding;
+        while (line_stream >> binding) {
+            addBinding(binding, bindings);
+        }
+        binding_sets.push_back(std::move(bindings));
+    }
+
+    return binding_sets;
+}
+
+// CSV: первая строка - имена переменных, остальные - значения по строкам
+slr::syntaxer::Columns readColumns(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        slr::utils::THROW("Can't open columns file '" + filename + "'");
+    }
+
+    slr::syntaxer::Columns columns;
+    std::string line;
+    size_t line_num = 0;
+    bool header = true;
+
+    while (std::getline(file, line)) {
+        ++line_num;
+        if (line.empty()) {
+            continue;
+        }
+
+        std::vector<std::string> cells;
+        std::istringstream line_stream(line);
+        std::string cell;
+        while (std::getline(line_stream, cell, ',')) {
+            const size_t begin = cell.find_first_not_of(" \t\r");
+            const size_t end = cell.find_last_not_of(" \t\r");
+            cells.push_back(begin == std::string::npos ? "" : cell.substr(begin, end - begin + 1));
+        }
+
+        if (header) {
+            columns.names = std::move(cells);
+            columns.values.resize(columns.names.size());
+            header = false;
+            continue;
+        }
+
+        if (cells.size() != columns.names.size()) {
+            slr::utils::THROW(filename + ":" + std::to_string(line_num) + ": expected " 
+                + std::to_string(columns.names.size()) + " values");
+        }
+        for (size_t col = 0; col < cells.size(); ++col) {
+            double value = 0;
+            const char* cell_end = cells[col].data() + cells[col].size();
+            if (std::from_chars(cells[col].data(), cell_end, value).ptr != cell_end || cells[col].empty()) {
+                slr::utils::THROW(filename + ":" + std::to_string(line_num) + ": bad number '" + cells[col] + "'");
+            }
+            columns.values[col].push_back(value);
+        }
+        ++columns.row_count;
+    }
+
+    return columns;
+}
+
+// Строка файла - OFFSET LENGTH TEXT: TEXT - остаток строки после пробела, \n, \t и \\ в нём - экранирование.
+// Пустые строки и строки с '#' пропускаются
+std::vector<slr::syntaxer::TextEdit> readEdits(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        slr::utils::THROW("Can't open edits file '" + filename + "'");
+    }
+
+    std::vector<slr::syntaxer::TextEdit> edits;
+    std::string line;
+    size_t line_num = 0;
+
+    while (std::getline(file, line)) {
+        ++line_num;
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+
+        slr::syntaxer::TextEdit edit{};
+        const char* const line_end = line.data() + line.size();
+        const auto [length_begin, begin_error] = std::from_chars(line.data(), line_end, edit.begin);
+        if (begin_error != std::errc{} || length_begin == line_end || *length_begin != ' ') {
+            slr::utils::THROW(filename + ":" + std::to_string(line_num) + ": expected OFFSET LENGTH TEXT");
+        }
+        const auto [text_begin, length_error] = std::from_chars(length_begin + 1, line_end, edit.length);
+        if (length_error != std::errc{} || (text_begin != line_end && *text_begin != ' ')) {
+            slr::utils::THROW(filename + ":" + std::to_string(line_num) + ": expected OFFSET LENGTH TEXT");
+        }
+
+        for (const char* p = (text_begin == line_end) ? line_end : text_begin + 1; p != line_end; ++p) {
+            if (*p != '\\' || p + 1 == line_end) {
+                edit.replacement += *p;
+                continue;
+            }
+            switch (*++p) {
+                case 'n':   edit.replacement += '\n';   break;
+                case 't':   edit.replacement += '\t';   break;
+                default:    edit.replacement += *p;     break;
+            }
+        }
+        edits.push_back(std::move(edit));
+    }
+
+    return edits;
+}
+
+}
 
 int main(int argc, char* argv[]) try {
     const slr::args::Args args(argc, argv);
@@ -19,6 +168,118 @@ int main(int argc, char* argv[]) try {
         return EXIT_SUCCESS;
     }
 
+    const auto lexer_kind = slr::lexer::LexerBackend::kindFromStr(args.getLexer());
+    if (!lexer_kind.has_value()) {
+        slr::utils::THROW("Unknown lexer '" + std::string(args.getLexer()) + "'");
+    }
+
+    const std::string lookahead_str = args.getLookahead().value_or("slr");
+    const auto lookahead = slr::syntaxer::ParsingTable::lookaheadFromStr(lookahead_str);
+    if (!lookahead.has_value()) {
+        slr::utils::THROW("Unknown lookahead '" + lookahead_str + "'");
+    }
+
+    const auto cache_eviction = slr::syntaxer::ParseCache::evictionFromStr(args.getCacheEviction());
+    if (!cache_eviction.has_value()) {
+        slr::utils::THROW("Unknown cache eviction '" + std::string(args.getCacheEviction()) + "'");
+    }
+
+    slr::driver::Options options;
+    options.verbose     = args.getVerbose();
+    options.fast        = args.getFast();
+    options.trace_limit = args.getTraceLimit();
+    options.lexer_kind  = *lexer_kind;
+    options.jobs        = args.getJobs();
+    options.ast         = args.getAst();
+    options.recover     = args.getRecover();
+    options.cache_capacity  = args.getCache();
+    options.cache_eviction  = *cache_eviction;
+    options.eval        = args.getCompile() ? slr::driver::EvalMode::BYTECODE
+                        : args.getEval()    ? slr::driver::EvalMode::DIRECT
+                        :                     slr::driver::EvalMode::NONE;
+
+    for (const auto& variable : args.getVariables()) {
+        addBinding(variable, options.variables);
+    }
+
+    if (args.getBindings().has_value()) {
+        if (options.eval != slr::driver::EvalMode::BYTECODE) {
+            slr::utils::THROW("--bindings requires --compile");
+        }
+        options.binding_sets = readBindingSets(*args.getBindings(), options.variables);
+    }
+
+    if (args.getColumns().has_value()) {
+        if (options.eval != slr::driver::EvalMode::BYTECODE || args.getBindings().has_value()) {
+            slr::utils::THROW("--columns requires --compile and can't be used with --bindings");
+        }
+        options.columns = readColumns(*args.getColumns());
+    }
+
+    if (args.getEdits().has_value()) {
+        if (options.eval != slr::driver::EvalMode::NONE || options.ast || options.recover) {
+            slr::utils::THROW("--edits can't be used with --eval, --compile, --ast or --recover");
+        }
+        options.edits = readEdits(*args.getEdits());
+    }
+
+    const auto grammar_ptr = args.getGrammar().has_value()
+        ?   std::make_unique<slr::syntaxer::Grammar>(*args.getGrammar())
+        :   std::make_unique<slr::syntaxer::Grammar>();
+    const slr::syntaxer::Grammar& grammar = *grammar_ptr;
+    const auto parsing_table = args.getLoadTable().has_value()
+        ?   std::make_unique<slr::syntaxer::ParsingTable>(grammar, *args.getLoadTable())
+        :   std::make_unique<slr::syntaxer::ParsingTable>(
+                grammar, 
+                *lookahead,
+                args.getRuntimeTable() ? slr::syntaxer::TableSource::RUNTIME : slr::syntaxer::TableSource::BUILTIN,
+                args.getJobs()
+            );
+
+    // режим загруженной таблицы записан в файле, явный --lookahead должен с ним совпадать
+    const bool table_lalr = (parsing_table->getLookaheadMode() == slr::syntaxer::LookaheadMode::LALR);
+    if (args.getLoadTable().has_value() && args.getLookahead().has_value() 
+        && parsing_table->getLookaheadMode() != *lookahead) {
+        slr::utils::THROW(
+            "Table file '" + *args.getLoadTable() + "' was built with --lookahead " 
+            + (table_lalr ? "lalr" : "slr") + ", not " + lookahead_str
+        );
+    }
+
+    if (!parsing_table->getConflicts().empty()) {
+        std::cerr << YELLOW_FORMAT << "Warning: grammar is not " 
+            << (table_lalr ? "LALR(1)" : "SLR(1)") << NORMAL_FORMAT;
+        parsing_table->printConflicts(std::cerr);
+    }
+
+    if (args.getDumpTable().has_value()) {
+        parsing_table->save(*args.getDumpTable());
+    }
+
+    slr::driver::Driver driver(grammar, *parsing_table, options);
+
+    if (args.isBatch()) {
+        const auto inputs = slr::driver::Driver::collectInputs(args.getBatchInputs(), args.getManifest());
+        const auto results = driver.runBatch(inputs, args.getOutputFilename());
+
+        slr::driver::Driver::printSummary(results);
+
+        if (options.cache_capacity != 0) {
+            const auto stats = driver.getCacheStats();
+            std::cout << "Cache: hits " << stats.hits << ", misses " << stats.misses << "\n";
+        }
+
+        bool all_processed = true;
+        for (const auto& result : results) {
+            if (result.failure.has_value()) {
+                std::cerr << RED_FORMAT << "EXCEPTION!!!\n" << *result.failure << NORMAL_FORMAT << "\n";
+                all_processed = false;
+            }
+        }
+
+        return all_processed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     slr::args::IOManger iomanager(args.getInputFilename(), args.getOutputFilename());
 
     if (args.getVerbose()) {
@@ -34,29 +295,21 @@ int main(int argc, char* argv[]) try {
             << "\n";
     }
 
-    slr::syntaxer::Grammar grammar;
-    slr::syntaxer::ParsingTable parsing_table(grammar);
-
-    if (args.getVerbose()) {
-        grammar.print(iomanager.getOutputFile());
-        parsing_table.print(iomanager.getOutputFile());
-    }
-
-    slr::lexer::Lexer lexer(&iomanager.getInputFile(), &iomanager.getOutputFile());
-
-    const auto& tokens = lexer.parse();
-
-    if (args.getVerbose()) {
-        lexer.print(iomanager.getOutputFile());
+    if (!options.edits.empty()) {
+        driver.processEdits(iomanager.getInputBuffer(), iomanager.getOutputFile());
+        return EXIT_SUCCESS;
     }
 
-    slr::syntaxer::Syntaxer syntaxer(grammar, parsing_table);
+    // потоково читать stdin умеет только flex-лексер, остальным нужен буфер целиком
+    const bool stream_stdin = driver.streams()
+        && *lexer_kind == slr::lexer::LexerKind::FLEX 
+        && !iomanager.getInputFilename().has_value();
 
-    const auto& parse_result = syntaxer.parse(tokens);
+    std::unique_ptr<slr::lexer::LexerBackend> lexer = stream_stdin
+        ?   std::make_unique<slr::lexer::Lexer>(&iomanager.getInputStream(), &iomanager.getOutputFile())
+        :   slr::lexer::makeLexer(*lexer_kind, iomanager.getInputBuffer(), &iomanager.getOutputFile());
 
-    if (args.getVerbose()) {
-        syntaxer.print(parse_result, iomanager.getOutputFile());
-    }
+    driver.process(*lexer, iomanager.getOutputFile());
 
     if (args.getVerbose()) {
         std::cout << "Parsing complete\n";
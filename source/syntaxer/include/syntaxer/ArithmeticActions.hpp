@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "syntaxer/Grammar.hpp"
+#include "lexer/tokens.hpp"
+
+namespace slr {
+namespace syntaxer {
+
+// Хеш для поиска в Bindings по std::string_view без создания строки
+struct StringHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view str) const noexcept {
+        return std::hash<std::string_view>{}(str);
+    }
+};
+
+// Значения переменных (ID)
+using Bindings = std::unordered_map<std::string, double, StringHash, std::equal_to<>>;
+
+// Вычисление выражений встроенной грамматики (BUILTIN_PRODUCTIONS) в double
+class ArithmeticActions {
+
+public:
+
+    using Value = double;
+
+    constexpr inline static size_t PRODUCTION_COUNT = BUILTIN_PRODUCTIONS.size();
+
+    explicit ArithmeticActions(const Bindings& variables);
+
+    // NUMBER - его значение, ID - значение переменной (nullopt, если не задана), остальные - 0
+    std::optional<double> shift(const lexer::Token& token) const;
+
+    static double numberValue(std::string_view number) noexcept;
+
+    // Действие выводится из правой части продукции
+    template <size_t PROD>
+    double reduce(std::span<const double> values) const noexcept {
+        constexpr const StaticProduction& prod = BUILTIN_PRODUCTIONS[PROD];
+
+        if constexpr (prod.body_size == 1) {
+            return values[0];
+        }
+        else if constexpr (prod.body[0] == Symbol::LBRACKET) {
+            return values[1];
+        }
+        else if constexpr (prod.body[1] == Symbol::PLUS) {
+            return values[0] + values[2];
+        }
+        else if constexpr (prod.body[1] == Symbol::MINUS) {
+            return values[0] - values[2];
+        }
+        else if constexpr (prod.body[1] == Symbol::MUL) {
+            return values[0] * values[2];
+        }
+        else {
+            static_assert(prod.body[1] == Symbol::DIV, "No arithmetic action for production");
+            return values[0] / values[2];
+        }
+    }
+
+private:
+
+    const Bindings& variables_;
+};
+
+}
+}
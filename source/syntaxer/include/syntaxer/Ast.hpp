@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "syntaxer/Grammar.hpp"
+
+namespace slr {
+namespace syntaxer {
+
+using NodeInd = uint32_t;
+
+// Узел дерева разбора. Лист - токен, его текст лежит в общем буфере текста дерева;
+// внутренний узел - свёртка продукции, его дети лежат подряд в общем массиве индексов
+struct AstNode {
+    Symbol symbol;
+    uint32_t prod_ind;  // для листа - PROD_NONE
+    uint32_t first;     // лист: начало текста, узел: начало детей
+    uint32_t count;     // лист: длина текста, узел: число детей
+    int line;           // строка первого токена узла
+
+    constexpr inline static uint32_t PROD_NONE = std::numeric_limits<uint32_t>::max();
+};
+
+// Дерево в арене: узлы, индексы детей и текст листьев - три непрерывных буфера,
+// вместо указателей - индексы. Всё дерево освобождается разом (clear или деструктор)
+class Ast {
+
+public:
+
+    constexpr inline static NodeInd NODE_NONE = std::numeric_limits<NodeInd>::max();
+
+    NodeInd addLeaf(Symbol terminal, std::string_view text, int line);
+
+    // children - индексы уже добавленных узлов в порядке правой части продукции,
+    // line - строка узла без детей (эпсилон-правило), иначе берётся у первого ребёнка
+    NodeInd addNode(Symbol head, size_t prod_ind, std::span<const NodeInd> children, int line);
+
+    const AstNode&              operator[]  (NodeInd node)  const noexcept;
+    std::span<const NodeInd>    getChildren (NodeInd node)  const noexcept;
+    std::string_view            getText     (NodeInd node)  const noexcept;
+    bool                        isLeaf      (NodeInd node)  const noexcept;
+
+    void                        setRoot     (NodeInd node)        noexcept;
+    NodeInd                     getRoot     ()              const noexcept;
+    size_t                      size        ()              const noexcept;
+    bool                        empty       ()              const noexcept;
+
+    // Память буферов остаётся для следующего разбора
+    void clear() noexcept;
+
+    void print(const Grammar& grammar, std::ostream& out = std::cout) const;
+
+private:
+
+    std::vector<AstNode> nodes_;
+    std::vector<NodeInd> children_;
+    std::string text_;
+    NodeInd root_ = NODE_NONE;
+};
+
+}
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "syntaxer/ArithmeticActions.hpp"
+#include "syntaxer/Grammar.hpp"
+#include "lexer/tokens.hpp"
+
+namespace slr {
+namespace syntaxer {
+
+// Стековый байткод выражения. *_K - операция с константой из пула вместо второго операнда
+// (top op k), R*_K - с переставленными операндами (k op top)
+enum class OpCode : uint32_t {
+    LOAD_CONST,
+    LOAD_VAR,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    ADD_K,
+    SUB_K,
+    RSUB_K,
+    MUL_K,
+    DIV_K,
+    RDIV_K
+};
+
+struct Instruction {
+    OpCode op;
+    uint32_t arg;   // номер константы или слот переменной
+};
+
+// Столбцовые данные: по столбцу значений на переменную, у всех столбцов row_count строк
+struct Columns {
+    std::vector<std::string> names;
+    std::vector<std::vector<double>> values;
+    size_t row_count = 0;
+
+    const std::vector<double>* find(std::string_view name) const noexcept;
+};
+
+class Bytecode {
+
+public:
+
+    void        emit            (OpCode op, uint32_t arg = 0);
+    uint32_t    addConstant     (double value);
+    // Одно имя - один слот, line - строка первого появления
+    uint32_t    addVariable     (std::string_view name, int line);
+
+    // Значения переменных в порядке слотов; nullopt, если какой-то переменной нет в bindings
+    std::optional<std::vector<double>> bind(const Bindings& bindings) const;
+
+    // stack - рабочий буфер, переиспользуется между вызовами
+    double evaluate(std::span<const double> variables, std::vector<double>& stack) const;
+
+    // Вычисление по строкам сразу: columns[slot] - значения переменной слота, результат строки i - в out[i].
+    // Строки идут блоками по BLOCK_ROWS, каждая инструкция выполняется над целым блоком SIMD-ядром
+    void evaluateColumns(
+        std::span<const std::span<const double>> columns, 
+        std::span<double> out, 
+        std::vector<double>& stack
+    ) const;
+
+    constexpr inline static size_t BLOCK_ROWS = 256;
+
+    const std::vector<Instruction>&     getCode         ()              const noexcept;
+    const std::vector<std::string>&     getVariableNames()              const noexcept;
+    int                                 getVariableLine (uint32_t slot) const noexcept;
+    size_t                              getMaxDepth     ()              const noexcept;
+
+    void clear() noexcept;
+
+    void print(std::ostream& out = std::cout) const;
+
+private:
+
+    std::vector<Instruction> code_;
+    std::vector<double> constants_;
+    std::vector<std::string> variable_names_;
+    std::vector<int> variable_lines_;
+
+    size_t depth_ = 0;
+    size_t max_depth_ = 0;
+};
+
+// Семантические действия для SemanticSyntaxer: компиляция выражения встроенной грамматики
+// в Bytecode. Свёртки идут в обратном польском порядке, поэтому код дописывается прямо на reduce.
+// Константы не выписываются, пока не встретятся с неконстантой, так что константные поддеревья сворачиваются
+class BytecodeCompiler {
+
+public:
+
+    struct Operand {
+        bool constant;
+        double value;   // только для constant
+    };
+
+    using Value = Operand;
+
+    constexpr inline static size_t PRODUCTION_COUNT = BUILTIN_PRODUCTIONS.size();
+
+    explicit BytecodeCompiler(Bytecode& program);
+
+    std::optional<Operand> shift(const lexer::Token& token);
+
+    template <size_t PROD>
+    Operand reduce(std::span<const Operand> values) {
+        constexpr const StaticProduction& prod = BUILTIN_PRODUCTIONS[PROD];
+
+        if constexpr (prod.body_size == 1) {
+            return values[0];
+        }
+        else if constexpr (prod.body[0] == Symbol::LBRACKET) {
+            return values[1];
+        }
+        else if constexpr (prod.body[1] == Symbol::PLUS) {
+            return binary(OpCode::ADD, OpCode::ADD_K, OpCode::ADD_K, values[0], values[2], values[0].value + values[2].value);
+        }
+        else if constexpr (prod.body[1] == Symbol::MINUS) {
+            return binary(OpCode::SUB, OpCode::SUB_K, OpCode::RSUB_K, values[0], values[2], values[0].value - values[2].value);
+        }
+        else if constexpr (prod.body[1] == Symbol::MUL) {
+            return binary(OpCode::MUL, OpCode::MUL_K, OpCode::MUL_K, values[0], values[2], values[0].value * values[2].value);
+        }
+        else {
+            static_assert(prod.body[1] == Symbol::DIV, "No bytecode for production");
+            return binary(OpCode::DIV, OpCode::DIV_K, OpCode::RDIV_K, values[0], values[2], values[0].value / values[2].value);
+        }
+    }
+
+    // После разбора: константный результат выписывается как LOAD_CONST
+    void finish(const Operand& result);
+
+private:
+
+    Operand binary(
+        OpCode op, OpCode op_k, OpCode rop_k,
+        const Operand& lhs, const Operand& rhs, double folded
+    );
+
+    Bytecode& program_;
+};
+
+}
+}
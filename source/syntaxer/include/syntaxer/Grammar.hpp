@@ -1,8 +1,10 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <iostream>
 #include <string>
-#include <unordered_set>
+#include <string_view>
 #include <vector>
 
 #include "lexer/tokens.hpp"
@@ -23,7 +25,8 @@ enum class Symbol : int {
     LBRACKET,
     RBRACKET,
     
-    // Нетерминалы
+    // Нетерминалы встроенной грамматики. В грамматике из файла нетерминалы
+    // нумеруются динамически начиная с NT_START (он всегда - пополняющий старт)
     NT_START,
     NT_SUM,
     NT_MUL,
@@ -32,23 +35,63 @@ enum class Symbol : int {
     COUNT
 };
 
+// Множество терминалов (они совпадают с lexer::TokenType) битовой маской: бит i - Symbol i
+using TerminalMask = uint64_t;
+
+static_assert(static_cast<size_t>(lexer::TokenType::COUNT) <= 64);
+
 struct Production {
     Symbol head;
-    std::vector<Symbol> body;
+    std::vector<Symbol> body;   // пустое - эпсилон-правило
     std::string name;
 };
 
+// Продукция встроенной грамматики в виде, пригодном для constexpr-вычислений
+struct StaticProduction {
+    constexpr inline static size_t MAX_BODY = 3;
+
+    Symbol head;
+    std::array<Symbol, MAX_BODY> body;
+    size_t body_size;
+    std::string_view name;
+};
+
+inline constexpr std::array<StaticProduction, 10> BUILTIN_PRODUCTIONS = {{
+    {Symbol::NT_START,  {Symbol::NT_SUM},                                       1, "<start> -> <sum>"},
+    {Symbol::NT_SUM,    {Symbol::NT_SUM, Symbol::PLUS, Symbol::NT_MUL},         3, "<sum> -> <sum> '+' <mul>"},
+    {Symbol::NT_SUM,    {Symbol::NT_SUM, Symbol::MINUS, Symbol::NT_MUL},        3, "<sum> -> <sum> '-' <mul>"},
+    {Symbol::NT_SUM,    {Symbol::NT_MUL},                                       1, "<sum> -> <mul>"},
+    {Symbol::NT_MUL,    {Symbol::NT_MUL, Symbol::MUL, Symbol::NT_BRAKETS},      3, "<mul> -> <mul> '*' <brakets>"},
+    {Symbol::NT_MUL,    {Symbol::NT_MUL, Symbol::DIV, Symbol::NT_BRAKETS},      3, "<mul> -> <mul> '/' <brakets>"},
+    {Symbol::NT_MUL,    {Symbol::NT_BRAKETS},                                   1, "<mul> -> <brakets>"},
+    {Symbol::NT_BRAKETS,{Symbol::LBRACKET, Symbol::NT_SUM, Symbol::RBRACKET},   3, "<brakets> -> '(' <sum> ')'"},
+    {Symbol::NT_BRAKETS,{Symbol::NUMBER},                                       1, "<brakets> -> NUM"},
+    {Symbol::NT_BRAKETS,{Symbol::ID},                                           1, "<brakets> -> ID"},
+}};
+
 class Grammar {
 
 public:
     Grammar();
+
+    // Загрузка продукций из текстового файла грамматики (см. README)
+    explicit Grammar(const std::string& grammar_filename);
     
     const std::vector<Production>&  getProductions()                    const noexcept;
     size_t                          getProductionCount()                const noexcept;
     std::string                     productionString(size_t prod_ind)   const noexcept;
+    size_t                          getSymbolCount()                    const noexcept;
+
+    // Отпечаток продукций, по нему проверяется совместимость сохранённой таблицы
+    uint64_t                        hash()                              const noexcept;
+
+    // Совпадают ли продукции с BUILTIN_PRODUCTIONS (тогда есть готовая таблица)
+    bool                            isBuiltin()                         const noexcept;
     
-    const std::unordered_set<Symbol>& getFollow(Symbol non_terminal) const;
-    const std::unordered_set<Symbol>& getFirst(Symbol symbol) const;
+    TerminalMask    getFollow   (Symbol non_terminal)   const noexcept;
+    TerminalMask    getFirst    (Symbol symbol)         const noexcept;
+    // Выводится ли из символа пустая строка
+    bool            isNullable  (Symbol symbol)         const noexcept;
 
     void print(std::ostream& out = std::cout) const;
     
@@ -57,14 +100,18 @@ public:
     
     static Symbol fromTokenType(lexer::TokenType token_type);
     
-    static std::string getSymbolStr         (Symbol s);
+    std::string        getSymbolStr         (Symbol s) const;
     static std::string getPrettySymbolStr   (Symbol s);
 
 private:
     std::vector<Production> productions_;
-    std::vector<std::unordered_set<Symbol>> first_sets_;
-    std::vector<std::unordered_set<Symbol>> follow_sets_;
+    std::vector<std::string> non_terminal_names_;   // по Symbol - NT_START
+    std::vector<TerminalMask> first_sets_;
+    std::vector<TerminalMask> follow_sets_;
+    std::vector<bool> nullable_;
     
+    // Все три - по очереди изменившихся символов: пересчитываются только зависящие от них
+    void buildNullable();
     void buildFirstSets();
     void buildFollowSets();
 };
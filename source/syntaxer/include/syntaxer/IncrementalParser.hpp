@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "syntaxer/Grammar.hpp"
+#include "syntaxer/ParsingTable.hpp"
+#include "syntaxer/Syntaxer.hpp"
+#include "lexer/LexerBackend.hpp"
+#include "lexer/tokens.hpp"
+
+namespace slr {
+namespace syntaxer {
+
+// Замена length символов с begin на replacement
+struct TextEdit {
+    size_t begin;
+    size_t length;
+    std::string replacement;
+};
+
+struct IncrementalResult {
+    std::optional<std::string> error_message;
+    std::optional<ParseErrorLocation> error_location;
+    size_t relexed_tokens = 0;      // токенов, выданных лексером при последнем разборе
+    size_t reparsed_tokens = 0;     // токенов, через которые прошёл автомат
+};
+
+// Документ, который разбирается заново после каждой правки (только распознавание, как ParseMode::RECOGNIZE).
+// Хранит текст, токены (смещениями в тексте) и снимки стека состояний через каждые CHECKPOINT_INTERVAL токенов.
+// Правка перелексирует текст от последнего незатронутого токена, пока поток токенов не совпадёт со старым,
+// автомат продолжает с последнего снимка до правки и останавливается, когда его стек совпал со старым снимком
+// за правкой: дальше разбор был бы тем же, что и раньше
+class IncrementalParser {
+
+public:
+
+    constexpr inline static size_t CHECKPOINT_INTERVAL = 64;
+
+    IncrementalParser(const Grammar& grammar, const ParsingTable& table, lexer::LexerKind lexer_kind);
+
+    // Полный разбор нового текста
+    const IncrementalResult& reset(std::string text);
+
+    const IncrementalResult& edit(const TextEdit& edit);
+
+    const std::string&          getText     () const noexcept;
+    size_t                      getTokenCount() const noexcept;
+    const IncrementalResult&    getResult   () const noexcept;
+
+private:
+
+    struct TokenSpan {
+        lexer::TokenType type;
+        size_t begin;
+        size_t length;
+        int line;
+    };
+
+    struct ErrorPoint {
+        size_t token_ind;
+        StateNum state;
+    };
+
+    // Стек состояний в момент, когда токен token_ind стал предпросмотром (сразу после shift предыдущего),
+    // и чем кончился разбор с этого места (токены за token_ind с тех пор не менялись)
+    struct Checkpoint {
+        size_t token_ind;
+        std::vector<StateNum> stack;
+        std::optional<ErrorPoint> outcome;
+    };
+
+    const ParsingTable& table_;
+    lexer::LexerKind lexer_kind_;
+
+    // Из грамматики нужны только длина правой части и левая часть продукции
+    std::vector<uint32_t> body_size_;
+    std::vector<Symbol> head_;
+
+    // Токены до места последней правки - с обычными смещениями, после - в обратном порядке, смещения
+    // отсчитаны от конца текста, строки - от строки END_OF_FILE (end_line_). Правка не трогает токены за
+    // собой, а поиск места правки двигает границу на расстояние от прошлой правки
+    std::string text_;
+    std::vector<TokenSpan> front_tokens_;
+    std::vector<TokenSpan> back_tokens_;
+    int end_line_ = 1;
+    // По возрастанию token_ind, первый - {0, {0}}. Снимки за ошибкой - от прежних разборов: по ним
+    // разбор сходится, когда правка исправила ошибку
+    std::vector<Checkpoint> checkpoints_;
+    std::optional<ErrorPoint> error_;           // nullopt - вход принят
+
+    IncrementalResult result_;
+    std::vector<StateNum> stack_;
+
+private:
+
+    // Токены text_ с позиции begin (строка line), пока не встретится токен, совпадающий со старым
+    // tokenAt(j) при j >= resync_from (старые токены с resync_from уже за границей); возвращает j
+    // или число токенов
+    size_t relex(size_t begin, int line, size_t resync_from, std::vector<TokenSpan>& out) const;
+
+    // Прогон автомата со снимка checkpoints_[keep - 1]. Снимки с tail - от прежних разборов (уже в новых
+    // номерах токенов), с номерами от converge_from они сравниваются со стеком; при совпадении остаются
+    // они и их outcome. Снимки между keep и совпавшим (или до места остановки) заменяются новыми
+    void run(size_t converge_from, size_t keep, size_t tail);
+
+    void setResult();
+
+    // Токен с обычными смещением и строкой
+    TokenSpan   tokenAt (size_t token_ind) const noexcept;
+    // Смещение и строка от конца и обратно
+    TokenSpan   fromEnd (const TokenSpan& span) const noexcept;
+    // Граница сразу перед токеном token_ind
+    void        moveGap (size_t token_ind);
+
+    // Первый токен с from, для которого pred ложно (pred истинно на префиксе)
+    template <typename Pred>
+    size_t findToken(size_t from, Pred pred) const {
+        size_t count = getTokenCount() - from;
+        while (count > 0) {
+            const size_t half = count / 2;
+            if (pred(tokenAt(from + half))) {
+                from += half + 1;
+                count -= half + 1;
+            }
+            else {
+                count = half;
+            }
+        }
+        return from;
+    }
+
+    lexer::Token makeToken(size_t token_ind) const noexcept;
+};
+
+}
+}
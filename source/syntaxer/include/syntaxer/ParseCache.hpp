@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "syntaxer/Syntaxer.hpp"
+#include "lexer/tokens.hpp"
+
+namespace slr {
+namespace syntaxer {
+
+enum class CacheEviction {
+    LRU,    // вытесняется давно не использованный результат
+    FIFO    // вытесняется самый старый, попадания порядок не меняют
+};
+
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+};
+
+// Кэш результатов разбора перед Syntaxer::parse. Ключ - хеш последовательности (тип, значение) токенов;
+// номера строк тоже сравниваются, т.к. они входят в сообщение об ошибке и в дерево.
+// Результаты зависят от настроек Syntaxer (режим, трасса, дерево), поэтому кэш - на один Syntaxer
+class ParseCache {
+
+public:
+
+    ParseCache(size_t capacity, CacheEviction eviction);
+
+    static std::optional<CacheEviction> evictionFromStr(std::string_view str) noexcept;
+
+    // При промахе разбирает через parse() и запоминает результат.
+    // Ссылка действительна до следующего вызова
+    template <typename Parse>
+    const ParseResult& parse(std::span<const lexer::Token> tokens, Parse&& parse) {
+        const uint64_t hash = hashTokens(tokens);
+
+        if (const auto entry = find(hash, tokens)) {
+            ++stats_.hits;
+            return (*entry)->result;
+        }
+
+        ++stats_.misses;
+        return insert(hash, tokens, parse());
+    }
+
+    CacheStats  getStats    () const noexcept;
+    size_t      size        () const noexcept;
+    size_t      getCapacity () const noexcept;
+
+    void clear() noexcept;
+
+private:
+
+    // Токены ключа хранятся в собственных буферах: value токена указывает во вход документа
+    struct Entry {
+        uint64_t hash;
+        std::vector<lexer::TokenType> types;
+        std::vector<int> lines;
+        std::vector<uint32_t> value_ends;
+        std::string text;
+        ParseResult result;
+
+        bool matches(std::span<const lexer::Token> tokens) const noexcept;
+    };
+
+    using EntryIter = std::list<Entry>::iterator;
+
+    static uint64_t hashTokens(std::span<const lexer::Token> tokens) noexcept;
+
+    std::optional<EntryIter> find(uint64_t hash, std::span<const lexer::Token> tokens);
+    const ParseResult& insert(uint64_t hash, std::span<const lexer::Token> tokens, ParseResult result);
+
+    size_t capacity_;
+    CacheEviction eviction_;
+
+    std::list<Entry> entries_;  // в начале - самые свежие
+    std::unordered_multimap<uint64_t, EntryIter> index_;
+
+    CacheStats stats_;
+};
+
+}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "syntaxer/Grammar.hpp"
+#include "syntaxer/ParsingTable.hpp"
+
+namespace slr {
+namespace syntaxer {
+
+// Шаг разбора хранится как дельта: действие, позиция во входе и символ предпросмотра.
+// Столбцы стека и входа восстанавливаются при печати.
+struct ParseStep {
+    ParseAction action;
+    size_t token_pos;
+    Symbol lookahead;
+};
+
+class ParseTrace {
+
+public:
+
+    constexpr inline static size_t UNLIMITED = 0;
+
+    explicit ParseTrace(size_t limit = UNLIMITED);
+
+    // Возвращает вытесненный шаг, если буфер заполнен
+    std::optional<ParseStep>    push            (const ParseStep& step);
+
+    const ParseStep&            operator[]      (size_t ind)    const noexcept;
+    size_t                      size            ()              const noexcept;
+    bool                        empty           ()              const noexcept;
+    size_t                      getLimit        ()              const noexcept;
+    size_t                      getDroppedCount ()              const noexcept;
+
+    // Стек символов перед первым сохранённым шагом
+    const std::vector<Symbol>&  getBaseStack    ()              const noexcept;
+    std::vector<Symbol>&        getBaseStack    ()                    noexcept;
+
+private:
+
+    size_t limit_;
+    std::vector<ParseStep> steps_;
+    size_t head_ = 0;
+    size_t dropped_ = 0;
+    std::vector<Symbol> base_stack_;
+};
+
+}
+}
\ No newline at end of file
@@ -1,13 +1,17 @@
 #pragma once
 
+#include <cstdint>
 #include <limits>
+#include <memory>
 #include <vector>
-#include <unordered_map>
 #include <optional>
 #include <string>
-#include <set>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
 
 #include "syntaxer/Grammar.hpp"
+#include "utils/MappedFile.hpp"
 
 namespace slr {
 namespace syntaxer {
@@ -19,64 +23,259 @@ enum class ActionType {
     ERROR
 };
 
+// Упакованная ячейка ACTION: тип в старших 2 битах, target в остальных
+using ActionCell = uint32_t;
+
 struct ParseAction {
     ActionType type;
     size_t target;      // SHIFT: state_ind, REDUCE: production_ind
-    std::string rule;   // REDUCE: productions[prodution_ind].name
 
     constexpr inline static size_t TARGET_POISION = std::numeric_limits<size_t>::max();
+
+    constexpr inline static unsigned   CELL_TYPE_SHIFT  = 30;
+    constexpr inline static ActionCell CELL_TARGET_MASK = (ActionCell{1} << CELL_TYPE_SHIFT) - 1;
     
-    static ParseAction shift    (size_t state)                              noexcept;
-    static ParseAction reduce   (size_t prod_ind, std::string rule_name)    noexcept;
-    static ParseAction accept   ()                                          noexcept;
-    static ParseAction error    ()                                          noexcept;
+    constexpr static ParseAction shift    (size_t state)      noexcept;
+    constexpr static ParseAction reduce   (size_t prod_ind)   noexcept;
+    constexpr static ParseAction accept   ()                  noexcept;
+    constexpr static ParseAction error    ()                  noexcept;
+
+    constexpr ActionCell          pack    ()                  const noexcept;
+    constexpr static ActionType   cellType(ActionCell cell)         noexcept;
+    constexpr static size_t       cellTarget(ActionCell cell)       noexcept;
 };
 
+static_assert(std::is_trivially_copyable_v<ParseAction>);
 
-struct Item {
-    size_t prod_ind; 
-    size_t dot_pos;
-    
-    Item(size_t prod_ind, size_t dot = 0) noexcept;
-    
-    auto operator<=>(const Item& other) const = default;
-};
+// constexpr, чтобы таблицу встроенной грамматики можно было собрать при компиляции
+constexpr ParseAction ParseAction::shift(size_t state) noexcept {
+    return {ActionType::SHIFT, state};
+}
+constexpr ParseAction ParseAction::reduce(size_t prod_ind) noexcept {
+    return {ActionType::REDUCE, prod_ind};
+}
+constexpr ParseAction ParseAction::accept() noexcept {
+    return {ActionType::ACCEPT, TARGET_POISION};
+}
+constexpr ParseAction ParseAction::error() noexcept {
+    return {ActionType::ERROR, TARGET_POISION};
+}
 
-using ItemSet = std::set<Item>;
+constexpr ActionCell ParseAction::pack() const noexcept {
+    const ActionCell target_bits = (target == TARGET_POISION) 
+        ?   CELL_TARGET_MASK 
+        :   static_cast<ActionCell>(target) & CELL_TARGET_MASK;
+    return (static_cast<ActionCell>(type) << CELL_TYPE_SHIFT) | target_bits;
+}
+
+constexpr ActionType ParseAction::cellType(ActionCell cell) noexcept {
+    return static_cast<ActionType>(cell >> CELL_TYPE_SHIFT);
+}
+
+constexpr size_t ParseAction::cellTarget(ActionCell cell) noexcept {
+    const ActionCell target_bits = cell & CELL_TARGET_MASK;
+    return (target_bits == CELL_TARGET_MASK) ? TARGET_POISION : target_bits;
+}
+
+
+// Итем - плотный номер: номер первого итема продукции + позиция точки,
+// так что порядок номеров совпадает с порядком (продукция, точка)
+using ItemId = uint32_t;
+
+// Набор итемов - отсортированный вектор номеров
+using ItemSet = std::vector<ItemId>;
 using StateVec = std::vector<ItemSet>;
 using StateNum = uint64_t;
+using GotoCell = uint32_t;
+
+struct Transition {
+    Symbol symbol;
+    StateNum target;
+};
+
+constexpr inline size_t TERMINAL_COUNT = static_cast<size_t>(lexer::TokenType::COUNT);
+
+// Сжатые таблицы разбора (строятся compressTables):
+//  ACTION - у состояния маска допустимых терминалов, reduce по умолчанию и номер строки в action_rows;
+//           строки (TERMINAL_COUNT ячеек, без reduce по умолчанию) у одинаковых состояний общие.
+//  GOTO   - строки состояний уложены со сдвигом goto_base в один массив goto_next,
+//           goto_check хранит состояние-владельца ячейки.
+struct CompressedTableView {
+    size_t state_count      = 0;
+    size_t row_count        = 0;
+    size_t goto_slot_count  = 0;
+
+    const TerminalMask* lookahead_mask  = nullptr;  // [state_count]
+    const ActionCell*   default_action  = nullptr;  // [state_count]
+    const uint32_t*     action_row      = nullptr;  // [state_count]
+    const ActionCell*   action_rows     = nullptr;  // [row_count * TERMINAL_COUNT]
+    const uint32_t*     goto_base       = nullptr;  // [state_count]
+    const uint32_t*     goto_check      = nullptr;  // [goto_slot_count]
+    const GotoCell*     goto_next       = nullptr;  // [goto_slot_count]
+};
+
+struct CompressedTables {
+    std::vector<TerminalMask>   lookahead_mask;
+    std::vector<ActionCell>     default_action;
+    std::vector<uint32_t>       action_row;
+    std::vector<ActionCell>     action_rows;
+    std::vector<uint32_t>       goto_base;
+    std::vector<uint32_t>       goto_check;
+    std::vector<GotoCell>       goto_next;
+
+    CompressedTableView view() const noexcept {
+        return {
+            lookahead_mask.size(), action_rows.size() / TERMINAL_COUNT, goto_check.size(),
+            lookahead_mask.data(), default_action.data(), action_row.data(), action_rows.data(),
+            goto_base.data(), goto_check.data(), goto_next.data()
+        };
+    }
+};
+
+enum class LookaheadMode {
+    SLR,    // предпросмотр reduce - FOLLOW левой части
+    LALR    // LALR(1): предпросмотр по DeRemer-Pennello поверх того же LR(0)-автомата
+};
+
+enum class ConflictType {
+    SHIFT_REDUCE,
+    REDUCE_REDUCE
+};
+
+// Конфликт в ячейке ACTION. Разрешается как в yacc: shift важнее reduce,
+// из двух reduce остаётся продукция с меньшим номером
+struct Conflict {
+    ConflictType type;
+    StateNum state;
+    Symbol lookahead;
+    ParseAction chosen;
+    ParseAction rejected;
+};
+
+// Заголовок бинарного файла таблицы, за ним массивы CompressedTableView в порядке объявления полей
+// и conflict_count записей TableFileConflict. Порядок байт - родной, проверяется по byte_order == ORDER_MARK.
+struct TableFileHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t grammar_hash;
+    uint32_t symbol_count;
+    uint32_t state_count;
+    uint32_t lookahead_mode;
+    uint32_t row_count;
+    uint32_t goto_slot_count;
+    uint32_t conflict_count;
+
+    constexpr inline static char     MAGIC[8]   = {'S', 'L', 'R', 'T', 'A', 'B', 'L', '\0'};
+    constexpr inline static uint32_t VERSION    = 4;
+    constexpr inline static uint32_t ORDER_MARK = 0x01020304;
+};
+
+static_assert(sizeof(TableFileHeader) == 48);
+
+// Конфликт в файле таблицы: действия - упакованные ячейки
+struct TableFileConflict {
+    uint64_t state;
+    uint32_t type;
+    uint32_t lookahead;
+    ActionCell chosen;
+    ActionCell rejected;
+};
+
+static_assert(sizeof(TableFileConflict) == 24);
+
+enum class TableSource {
+    BUILTIN,    // для встроенной грамматики взять таблицу, собранную при компиляции
+    RUNTIME     // всегда строить таблицу по грамматике
+};
 
 class ParsingTable {
 
 public:
 
-    ParsingTable(const Grammar& grammar);
+    ParsingTable(
+        const Grammar& grammar, 
+        LookaheadMode mode = LookaheadMode::SLR, 
+        TableSource source = TableSource::BUILTIN,
+        size_t jobs = 1     // потоков для построения LR(0)-автомата, 0 - по числу ядер
+    );
+
+    // Загрузка таблицы, ранее сохранённой save(), без построения
+    ParsingTable(const Grammar& grammar, const std::string& table_filename);
+
+    ParsingTable(const ParsingTable& that) = delete;
+    ParsingTable& operator=(const ParsingTable& that) = delete;
+
+    void save(const std::string& table_filename) const;
     
     ParseAction getAction(StateNum state, Symbol terminal) const;
     std::optional<StateNum> getGoto(StateNum state, Symbol non_terminal) const;
+
+    ActionCell getActionCell(StateNum state, Symbol terminal) const noexcept;
+    // Терминалы, действие по которым в state - не ошибка
+    TerminalMask getExpected(StateNum state) const noexcept;
     
     void print(std::ostream& out = std::cout) const;
+    void printConflicts(std::ostream& out = std::cout) const;
     
-    size_t getStateCount() const { return states_.size(); }
+    size_t getStateCount() const { return table_.state_count; }
+
+    LookaheadMode                   getLookaheadMode()  const noexcept;
+    const std::vector<Conflict>&    getConflicts()      const noexcept;
+
+    static std::optional<LookaheadMode> lookaheadFromStr(std::string_view str) noexcept;
+
+    constexpr inline static GotoCell GOTO_NONE = std::numeric_limits<GotoCell>::max();
     
 private:
 
     const Grammar& grammar_;
+    size_t symbol_count_;
+    LookaheadMode mode_ = LookaheadMode::SLR;
+    size_t build_jobs_ = 1;
+    std::vector<Conflict> conflicts_;
     
+    // Состояние хранится ядром: closure добавляет только итемы с точкой в начале,
+    // их задаёт маска нетерминалов (closureMask)
     StateVec states_;
-    
-    std::vector<std::unordered_map<Symbol, ParseAction>> action_table_;
-    std::vector<std::unordered_map<Symbol, StateNum>> goto_table_;
+
+    // Используются только при построении: переходы каждого состояния, найденные в BFS,
+    // и номера продукций по нетерминалу в левой части
+    std::vector<std::vector<Transition>> transitions_;
+    std::vector<std::vector<size_t>> prods_by_head_;
+
+    // Номер первого итема продукции, продукция итема и символ после точки (UNKNOWN - итем законченный)
+    std::vector<ItemId> item_offset_;
+    std::vector<uint32_t> item_prod_;
+    std::vector<Symbol> item_symbol_;
+    bool has_epsilon_ = false;
+
+    // Строка нетерминала A (nt_words_ слов) - нетерминалы, чьи продукции closure добавляет
+    // из-за итема с A после точки, включая сам A
+    size_t nt_words_ = 0;
+    std::vector<uint64_t> nt_closure_;
+
+    // Сжатые таблицы для разбора.
+    // Указывают в storage_, в отображённый файл таблицы или в static_table::BUILTIN_COMPRESSED
+    CompressedTableView table_;
+
+    CompressedTables storage_;
+    std::unique_ptr<utils::MappedFile> table_file_;
 
 private:
     
-    ItemSet closure(const ItemSet& items);
-    ItemSet gotoState(const ItemSet& items, Symbol symbol);
+    void buildItemIndex();
+    // Маска нетерминалов замыкания ядра - OR строк nt_closure_ по символам после точки
+    void closureMask(const ItemSet& kernel, std::vector<uint64_t>& mask) const;
     void buildCanonicalCollection();
     void buildTables();
+    void setAction(ActionCell* action_row, StateNum state, Symbol terminal, ParseAction action);
+
+    // Предпросмотр LALR(1): для каждого состояния - продукция законченного итема -> терминалы
+    std::vector<std::unordered_map<size_t, TerminalMask>> buildLalrLookaheads() const;
     
-    bool isCompleteItem(const Item& item) const;
-    Symbol symbolAtDot(const Item& item) const;
+    bool isCompleteItem(ItemId item) const noexcept;
+    Symbol symbolAtDot(ItemId item) const noexcept;
 };
 
 }
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "syntaxer/Grammar.hpp"
+#include "syntaxer/ParsingTable.hpp"
+#include "syntaxer/Syntaxer.hpp"
+#include "lexer/tokens.hpp"
+#include "lexer/TokenStream.hpp"
+#include "utils/common.hpp"
+
+namespace slr {
+namespace syntaxer {
+
+// Семантические действия: значение каждого терминала при shift и свёртка значений правой части
+// при reduce. reduce<P> - шаблон по номеру продукции, чтобы выбрать его можно было при компиляции.
+// shift возвращает nullopt, если у токена нет значения (например, неизвестная переменная):
+// разбор продолжается с Value{} на его месте
+template <typename T>
+concept SemanticActions = requires(T& actions, const lexer::Token& token, std::span<const typename T::Value> values) {
+    requires std::default_initializable<typename T::Value>;
+    { T::PRODUCTION_COUNT }                     -> std::convertible_to<size_t>;
+    { actions.shift(token) }                    -> std::same_as<std::optional<typename T::Value>>;
+    { actions.template reduce<0>(values) }      -> std::same_as<typename T::Value>;
+};
+
+template <typename Value>
+struct SemanticResult {
+    std::optional<Value> value;
+    std::optional<std::string> error_message;
+    std::optional<ParseErrorLocation> error_location;
+};
+
+// Разбор с вычислением: вместо стека символов - стек значений Actions::Value,
+// действие продукции берётся из таблицы указателей, собранной при компиляции
+template <SemanticActions Actions>
+class SemanticSyntaxer {
+
+public:
+
+    using Value = typename Actions::Value;
+
+    SemanticSyntaxer(const Grammar& grammar, const ParsingTable& table, Actions& actions);
+
+    SemanticResult<Value> parse(lexer::TokenStream& tokens);
+    SemanticResult<Value> parse(const std::vector<lexer::Token>& tokens);
+
+private:
+
+    using ReduceFn = Value (*)(Actions& actions, std::span<const Value> values);
+
+    template <size_t... PRODS>
+    constexpr static std::array<ReduceFn, sizeof...(PRODS)> makeReduceTable(std::index_sequence<PRODS...>) {
+        return {{
+            [](Actions& actions, std::span<const Value> values) {
+                return actions.template reduce<PRODS>(values);
+            }...
+        }};
+    }
+
+    constexpr inline static auto REDUCE_TABLE = makeReduceTable(std::make_index_sequence<Actions::PRODUCTION_COUNT>{});
+
+    const ParsingTable& table_;
+    Actions& actions_;
+
+    // Из грамматики нужны только длина правой части и левая часть продукции
+    std::vector<uint32_t> body_size_;
+    std::vector<Symbol> head_;
+
+    std::vector<StateNum> state_stack_;
+    std::vector<Value> value_stack_;
+};
+
+template <SemanticActions Actions>
+SemanticSyntaxer<Actions>::SemanticSyntaxer(const Grammar& grammar, const ParsingTable& table, Actions& actions)
+    :   table_(table)
+    ,   actions_(actions)
+{
+    if (grammar.getProductionCount() != Actions::PRODUCTION_COUNT) {
+        utils::THROW(
+            "Semantic actions are defined for " + std::to_string(Actions::PRODUCTION_COUNT)
+            + " productions, grammar has " + std::to_string(grammar.getProductionCount())
+        );
+    }
+
+    for (const auto& prod : grammar.getProductions()) {
+        body_size_.push_back(static_cast<uint32_t>(prod.body.size()));
+        head_.push_back(prod.head);
+    }
+}
+
+template <SemanticActions Actions>
+SemanticResult<typename Actions::Value> SemanticSyntaxer<Actions>::parse(const std::vector<lexer::Token>& tokens) {
+    lexer::VectorTokenStream stream(tokens);
+    return parse(stream);
+}
+
+template <SemanticActions Actions>
+SemanticResult<typename Actions::Value> SemanticSyntaxer<Actions>::parse(lexer::TokenStream& tokens) {
+    SemanticResult<Value> result;
+
+    state_stack_.clear();
+    state_stack_.push_back(0);
+    value_stack_.clear();
+
+    size_t token_pos = 0;
+    const lexer::Token* token = &tokens.next();
+
+    auto setError = [&](std::string message) {
+        result.error_message = std::move(message);
+        result.error_location = ParseErrorLocation{token_pos, token->line};
+        return result;
+    };
+
+    while (true) {
+        const StateNum current_state = state_stack_.back();
+        const ActionCell cell = table_.getActionCell(current_state, Grammar::fromTokenType(token->type));
+
+        switch (ParseAction::cellType(cell)) {
+            case ActionType::SHIFT: {
+                // о токене без значения сообщается на ACCEPT: синтаксическая ошибка дальше важнее
+                std::optional<Value> value = actions_.shift(*token);
+                if (!value.has_value() && !result.error_message.has_value()) {
+                    result.error_message =
+                        "Semantic error in line " + std::to_string(token->line)
+                        + ", token " + std::string(token->value) + " has no value";
+                    result.error_location = ParseErrorLocation{token_pos, token->line};
+                }
+                state_stack_.push_back(ParseAction::cellTarget(cell));
+                value_stack_.push_back(value.has_value() ? std::move(*value) : Value{});
+
+                token = &tokens.next();
+                ++token_pos;
+                break;
+            }
+
+            case ActionType::REDUCE: {
+                const size_t prod_ind = ParseAction::cellTarget(cell);
+                const size_t body_size = body_size_[prod_ind];
+                if (body_size >= state_stack_.size()) {
+                    return setError("Reduce failed. Line " + std::to_string(token->line));
+                }
+                const size_t values_begin = value_stack_.size() - body_size;
+
+                Value value = REDUCE_TABLE[prod_ind](
+                    actions_,
+                    std::span<const Value>(value_stack_.data() + values_begin, body_size)
+                );
+                value_stack_.resize(values_begin);
+                value_stack_.push_back(std::move(value));
+
+                state_stack_.resize(state_stack_.size() - body_size);
+                const auto goto_state = table_.getGoto(state_stack_.back(), head_[prod_ind]);
+                if (!goto_state) {
+                    return setError("Reduce failed. Line " + std::to_string(token->line));
+                }
+                state_stack_.push_back(*goto_state);
+                break;
+            }
+
+            case ActionType::ACCEPT: {
+                if (!result.error_message.has_value()) {
+                    result.value = std::move(value_stack_.back());
+                }
+                return result;
+            }
+
+            case ActionType::ERROR:
+            default: {
+                return setError(
+                    "Syntax error in line " + std::to_string(token->line) + ", token is "
+                    + std::string(token->value) + "(state " + std::to_string(current_state) + ")"
+                );
+            }
+        }
+    }
+}
+
+}
+}
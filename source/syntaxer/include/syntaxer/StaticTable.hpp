@@ -0,0 +1,371 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "syntaxer/Grammar.hpp"
+#include "syntaxer/ParsingTable.hpp"
+#include "syntaxer/TableCompression.hpp"
+
+namespace slr {
+namespace syntaxer {
+namespace static_table {
+
+// Построение SLR(1)-таблицы при компиляции. Алгоритм повторяет ParsingTable::buildCanonicalCollection
+// и buildTables (тот же порядок обхода), поэтому номера состояний совпадают с runtime-построением.
+// Множества символов - битовые маски, наборы итемов - битовые маски по плоскому номеру итема.
+
+using SymbolMask = uint32_t;
+
+static_assert(static_cast<size_t>(Symbol::COUNT) <= 32);
+
+constexpr size_t SYMBOL_COUNT = static_cast<size_t>(Symbol::COUNT);
+
+template <size_t PROD_COUNT>
+using Productions = std::array<StaticProduction, PROD_COUNT>;
+
+constexpr bool isTerminal(Symbol sym) {
+    return sym > Symbol::UNKNOWN && sym < static_cast<Symbol>(lexer::TokenType::COUNT);
+}
+
+constexpr bool isNonTerminal(Symbol sym) {
+    return sym >= Symbol::NT_START && sym < Symbol::COUNT;
+}
+
+constexpr SymbolMask bit(Symbol sym) {
+    return SymbolMask{1} << static_cast<size_t>(sym);
+}
+
+template <size_t PROD_COUNT>
+constexpr size_t countItems(const Productions<PROD_COUNT>& prods) {
+    size_t count = 0;
+    for (const auto& prod : prods) {
+        count += prod.body_size + 1;
+    }
+    return count;
+}
+
+template <size_t PROD_COUNT>
+constexpr std::array<SymbolMask, SYMBOL_COUNT> buildFirst(const Productions<PROD_COUNT>& prods) {
+    std::array<SymbolMask, SYMBOL_COUNT> first{};
+
+    for (size_t sym_ind = 0; sym_ind < SYMBOL_COUNT; ++sym_ind) {
+        if (isTerminal(static_cast<Symbol>(sym_ind))) {
+            first[sym_ind] = bit(static_cast<Symbol>(sym_ind));
+        }
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const auto& prod : prods) {
+            SymbolMask& head = first[static_cast<size_t>(prod.head)];
+            const SymbolMask merged = head | first[static_cast<size_t>(prod.body[0])];
+            changed |= (merged != head);
+            head = merged;
+        }
+    }
+
+    return first;
+}
+
+template <size_t PROD_COUNT>
+constexpr std::array<SymbolMask, SYMBOL_COUNT> buildFollow(const Productions<PROD_COUNT>& prods) {
+    const auto first = buildFirst(prods);
+    std::array<SymbolMask, SYMBOL_COUNT> follow{};
+
+    follow[static_cast<size_t>(Symbol::NT_START)] = bit(Symbol::END_OF_FILE);
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const auto& prod : prods) {
+            for (size_t sym_ind = 0; sym_ind < prod.body_size; ++sym_ind) {
+                const Symbol sym = prod.body[sym_ind];
+                if (!isNonTerminal(sym)) {
+                    continue;
+                }
+
+                const SymbolMask to_add = (sym_ind + 1 == prod.body_size)
+                    ?   follow[static_cast<size_t>(prod.head)]
+                    :   first[static_cast<size_t>(prod.body[sym_ind + 1])];
+
+                SymbolMask& current = follow[static_cast<size_t>(sym)];
+                changed |= ((current | to_add) != current);
+                current |= to_add;
+            }
+        }
+    }
+
+    return follow;
+}
+
+template <size_t STATE_COUNT>
+struct Tables {
+    size_t state_count;
+    std::array<ActionCell, STATE_COUNT * SYMBOL_COUNT> action;
+    std::array<GotoCell,   STATE_COUNT * SYMBOL_COUNT> goto_;
+};
+
+template <size_t PROD_COUNT, size_t ITEM_COUNT, size_t MAX_STATES>
+class Builder {
+public:
+    using ItemMask = std::array<uint64_t, (ITEM_COUNT + 63) / 64>;
+
+    constexpr explicit Builder(const Productions<PROD_COUNT>& prods)
+        :   prods_(prods)
+    {
+        size_t offset = 0;
+        for (size_t prod_ind = 0; prod_ind < PROD_COUNT; ++prod_ind) {
+            item_offset_[prod_ind] = offset;
+            for (size_t dot = 0; dot <= prods_[prod_ind].body_size; ++dot) {
+                item_prod_[offset + dot] = prod_ind;
+                item_dot_[offset + dot] = dot;
+            }
+            offset += prods_[prod_ind].body_size + 1;
+        }
+
+        buildCanonicalCollection();
+    }
+
+    constexpr size_t getStateCount() const { return state_count_; }
+
+    template <size_t STATE_COUNT>
+    constexpr Tables<STATE_COUNT> buildTables() const {
+        static_assert(STATE_COUNT <= MAX_STATES);
+        assert(STATE_COUNT == state_count_);
+
+        const auto follow = buildFollow(prods_);
+
+        Tables<STATE_COUNT> tables{};
+        tables.state_count = state_count_;
+        tables.action.fill(ParseAction::error().pack());
+        tables.goto_.fill(ParsingTable::GOTO_NONE);
+
+        for (size_t state_ind = 0; state_ind < state_count_; ++state_ind) {
+            const ItemMask& items = states_[state_ind];
+            ActionCell* action_row = tables.action.data() + state_ind * SYMBOL_COUNT;
+            GotoCell* goto_row = tables.goto_.data() + state_ind * SYMBOL_COUNT;
+
+            for (size_t item = 0; item < ITEM_COUNT; ++item) {
+                if (!has(items, item)) {
+                    continue;
+                }
+                const StaticProduction& prod = prods_[item_prod_[item]];
+
+                if (item_dot_[item] < prod.body_size) { // SHIFT
+                    const Symbol next_sym = prod.body[item_dot_[item]];
+                    if (isTerminal(next_sym)) {
+                        action_row[static_cast<size_t>(next_sym)] =
+                            ParseAction::shift(findState(gotoState(items, next_sym))).pack();
+                    }
+                }
+                else if (prod.head == Symbol::NT_START && item_dot_[item] == 1) {
+                    action_row[static_cast<size_t>(Symbol::END_OF_FILE)] = ParseAction::accept().pack();
+                }
+                else { // REDUCE
+                    for (size_t term = 0; term < SYMBOL_COUNT; ++term) {
+                        if (follow[static_cast<size_t>(prod.head)] & (SymbolMask{1} << term)) {
+
+                            assert(action_row[term] == ParseAction::error().pack());
+
+                            action_row[term] = ParseAction::reduce(item_prod_[item]).pack();
+                        }
+                    }
+                }
+            }
+
+            for (size_t sym_ind = 0; sym_ind < SYMBOL_COUNT; ++sym_ind) {
+                const Symbol sym = static_cast<Symbol>(sym_ind);
+                if (isNonTerminal(sym)) {
+                    const ItemMask next = gotoState(items, sym);
+                    if (!empty(next)) {
+                        goto_row[sym_ind] = static_cast<GotoCell>(findState(next));
+                    }
+                }
+            }
+        }
+
+        return tables;
+    }
+
+private:
+    Productions<PROD_COUNT> prods_;
+
+    std::array<size_t, PROD_COUNT> item_offset_{};
+    std::array<size_t, ITEM_COUNT> item_prod_{};
+    std::array<size_t, ITEM_COUNT> item_dot_{};
+
+    std::array<ItemMask, MAX_STATES> states_{};
+    size_t state_count_ = 0;
+
+    constexpr static bool has(const ItemMask& mask, size_t item) {
+        return (mask[item / 64] >> (item % 64)) & 1;
+    }
+
+    constexpr static void set(ItemMask& mask, size_t item) {
+        mask[item / 64] |= uint64_t{1} << (item % 64);
+    }
+
+    constexpr static bool empty(const ItemMask& mask) {
+        for (uint64_t word : mask) {
+            if (word != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr Symbol symbolAtDot(size_t item) const {
+        const StaticProduction& prod = prods_[item_prod_[item]];
+        return (item_dot_[item] < prod.body_size) ? prod.body[item_dot_[item]] : Symbol::UNKNOWN;
+    }
+
+    constexpr ItemMask closure(ItemMask items) const {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t item = 0; item < ITEM_COUNT; ++item) {
+                if (!has(items, item) || !isNonTerminal(symbolAtDot(item))) {
+                    continue;
+                }
+                for (size_t prod_ind = 0; prod_ind < PROD_COUNT; ++prod_ind) {
+                    if (prods_[prod_ind].head == symbolAtDot(item) && !has(items, item_offset_[prod_ind])) {
+                        set(items, item_offset_[prod_ind]);
+                        changed = true;
+                    }
+                }
+            }
+        }
+        return items;
+    }
+
+    constexpr ItemMask gotoState(const ItemMask& items, Symbol sym) const {
+        ItemMask result{};
+        for (size_t item = 0; item < ITEM_COUNT; ++item) {
+            if (has(items, item) && symbolAtDot(item) == sym) {
+                set(result, item + 1);
+            }
+        }
+        return closure(result);
+    }
+
+    constexpr size_t findState(const ItemMask& items) const {
+        for (size_t state_ind = 0; state_ind < state_count_; ++state_ind) {
+            if (states_[state_ind] == items) {
+                return state_ind;
+            }
+        }
+        return MAX_STATES;
+    }
+
+    // Очередь BFS совпадает с порядком добавления состояний, поэтому отдельная очередь не нужна
+    constexpr void buildCanonicalCollection() {
+        ItemMask initial{};
+        for (size_t prod_ind = 0; prod_ind < PROD_COUNT; ++prod_ind) {
+            if (prods_[prod_ind].head == Symbol::NT_START) {
+                set(initial, item_offset_[prod_ind]);
+                break;
+            }
+        }
+        states_[state_count_++] = closure(initial);
+
+        for (size_t state_ind = 0; state_ind < state_count_; ++state_ind) {
+            for (size_t sym_ind = 1; sym_ind < SYMBOL_COUNT; ++sym_ind) {
+                const ItemMask next = gotoState(states_[state_ind], static_cast<Symbol>(sym_ind));
+
+                if (!empty(next) && findState(next) == MAX_STATES) {
+                    assert(state_count_ < MAX_STATES);
+                    states_[state_count_++] = next;
+                }
+            }
+        }
+    }
+};
+
+// Плотные таблицы Builder -> вход compressTables
+template <size_t STATE_COUNT>
+constexpr CompressedTables compress(const Tables<STATE_COUNT>& tables) {
+    std::vector<ActionCell> action(STATE_COUNT * TERMINAL_COUNT);
+    std::vector<GotoRow> goto_rows(STATE_COUNT);
+
+    for (size_t state_ind = 0; state_ind < STATE_COUNT; ++state_ind) {
+        for (size_t term = 0; term < TERMINAL_COUNT; ++term) {
+            action[state_ind * TERMINAL_COUNT + term] = tables.action[state_ind * SYMBOL_COUNT + term];
+        }
+        for (size_t sym_ind = static_cast<size_t>(Symbol::NT_START); sym_ind < SYMBOL_COUNT; ++sym_ind) {
+            const GotoCell cell = tables.goto_[state_ind * SYMBOL_COUNT + sym_ind];
+            if (cell != ParsingTable::GOTO_NONE) {
+                goto_rows[state_ind].emplace_back(sym_ind - static_cast<size_t>(Symbol::NT_START), cell);
+            }
+        }
+    }
+
+    return compressTables(action, goto_rows);
+}
+
+// Сжатые таблицы в массивах фиксированного размера: constexpr-вектор не может пережить компиляцию
+template <size_t STATE_COUNT, size_t ROW_COUNT, size_t SLOT_COUNT>
+struct CompressedArrays {
+    std::array<TerminalMask, STATE_COUNT>               lookahead_mask{};
+    std::array<ActionCell,   STATE_COUNT>               default_action{};
+    std::array<uint32_t,     STATE_COUNT>               action_row{};
+    std::array<ActionCell,   ROW_COUNT * TERMINAL_COUNT> action_rows{};
+    std::array<uint32_t,     STATE_COUNT>               goto_base{};
+    std::array<uint32_t,     SLOT_COUNT>                goto_check{};
+    std::array<GotoCell,     SLOT_COUNT>                goto_next{};
+
+    CompressedTableView view() const noexcept {
+        return {
+            STATE_COUNT, ROW_COUNT, SLOT_COUNT,
+            lookahead_mask.data(), default_action.data(), action_row.data(), action_rows.data(),
+            goto_base.data(), goto_check.data(), goto_next.data()
+        };
+    }
+};
+
+template <size_t ROW_COUNT, size_t SLOT_COUNT, size_t STATE_COUNT>
+constexpr CompressedArrays<STATE_COUNT, ROW_COUNT, SLOT_COUNT> freeze(const Tables<STATE_COUNT>& tables) {
+    const CompressedTables compressed = compress(tables);
+    assert(compressed.action_rows.size() == ROW_COUNT * TERMINAL_COUNT);
+    assert(compressed.goto_check.size() == SLOT_COUNT);
+
+    CompressedArrays<STATE_COUNT, ROW_COUNT, SLOT_COUNT> arrays;
+    std::copy(compressed.lookahead_mask.begin(), compressed.lookahead_mask.end(), arrays.lookahead_mask.begin());
+    std::copy(compressed.default_action.begin(), compressed.default_action.end(), arrays.default_action.begin());
+    std::copy(compressed.action_row.begin(),     compressed.action_row.end(),     arrays.action_row.begin());
+    std::copy(compressed.action_rows.begin(),    compressed.action_rows.end(),    arrays.action_rows.begin());
+    std::copy(compressed.goto_base.begin(),      compressed.goto_base.end(),      arrays.goto_base.begin());
+    std::copy(compressed.goto_check.begin(),     compressed.goto_check.end(),     arrays.goto_check.begin());
+    std::copy(compressed.goto_next.begin(),      compressed.goto_next.end(),      arrays.goto_next.begin());
+    return arrays;
+}
+
+// Таблицы встроенной грамматики (BUILTIN_PRODUCTIONS), посчитанные при компиляции
+
+inline constexpr size_t BUILTIN_MAX_STATES = 128;
+
+using BuiltinBuilder = Builder<
+    BUILTIN_PRODUCTIONS.size(),
+    countItems(BUILTIN_PRODUCTIONS),
+    BUILTIN_MAX_STATES
+>;
+
+inline constexpr size_t BUILTIN_STATE_COUNT = BuiltinBuilder(BUILTIN_PRODUCTIONS).getStateCount();
+
+inline constexpr Tables<BUILTIN_STATE_COUNT> BUILTIN_TABLES =
+    BuiltinBuilder(BUILTIN_PRODUCTIONS).buildTables<BUILTIN_STATE_COUNT>();
+
+// Сначала размеры сжатых массивов, затем сами массивы
+inline constexpr size_t BUILTIN_ROW_COUNT  = compress(BUILTIN_TABLES).action_rows.size() / TERMINAL_COUNT;
+inline constexpr size_t BUILTIN_GOTO_SLOTS = compress(BUILTIN_TABLES).goto_check.size();
+
+inline constexpr CompressedArrays<BUILTIN_STATE_COUNT, BUILTIN_ROW_COUNT, BUILTIN_GOTO_SLOTS> BUILTIN_COMPRESSED =
+    freeze<BUILTIN_ROW_COUNT, BUILTIN_GOTO_SLOTS>(BUILTIN_TABLES);
+
+}
+}
+}
@@ -1,51 +1,107 @@
 #pragma once
 
 #include <iostream>
-#include <utility>
+#include <optional>
 #include <vector>
 #include <string>
 
+#include "syntaxer/Ast.hpp"
 #include "syntaxer/Grammar.hpp"
 #include "syntaxer/ParsingTable.hpp"
+#include "syntaxer/ParseTrace.hpp"
 #include "lexer/tokens.hpp"
+#include "lexer/TokenStream.hpp"
 
 namespace slr {
 namespace syntaxer {
 
-struct ParseStep {
-    std::string stack;
-    std::string input;
-    std::string action;
+enum class ParseMode {
+    TRACE,      // записывать каждый шаг разбора
+    RECOGNIZE   // только успех/ошибка и место ошибки
+};
+
+struct ParseErrorLocation {
+    size_t token_ind;
+    int line;
+};
+
+struct Diagnostic {
+    std::string message;
+    ParseErrorLocation location;
+    TerminalMask expected;  // терминалы, допустимые в месте ошибки
+    size_t skipped;         // токенов пропущено при восстановлении
 };
 
 struct ParseResult {
-    std::vector<ParseStep> steps;
-    std::optional<std::string> error_message;
+    ParseTrace trace;
+    std::optional<std::string> error_message;           // первая ошибка
+    std::optional<ParseErrorLocation> error_location;
+    std::vector<Diagnostic> diagnostics;                // все ошибки, без восстановления - не больше одной
+    Ast ast;    // пустое, если дерево не строилось или разбор с ошибкой
 };
 
 class Syntaxer {
 public:
-    Syntaxer(const Grammar& grammar, const ParsingTable& table);
+    Syntaxer(const Grammar& grammar, const ParsingTable& table, ParseMode mode = ParseMode::TRACE);
     
     ParseResult parse(const std::vector<lexer::Token>& tokens);
+    ParseResult parse(lexer::TokenStream& tokens);
     
-    void print(const ParseResult& result, std::ostream& out = std::cout) const;
+    void print(
+        const ParseResult& result, 
+        const std::vector<lexer::Token>& tokens, 
+        std::ostream& out = std::cout
+    ) const;
+
+    void        setMode         (ParseMode mode)    noexcept;
+    ParseMode   getMode         ()          const   noexcept;
+    void        setTraceLimit   (size_t limit)      noexcept;
+    size_t      getTraceLimit   ()          const   noexcept;
+    void        setBuildAst     (bool build)        noexcept;
+    bool        getBuildAst     ()          const   noexcept;
+    void        setRecover      (bool recover)      noexcept;
+    bool        getRecover      ()          const   noexcept;
     
 private:
     const Grammar& grammar_;
     const ParsingTable& table_;
+
+    ParseMode mode_;
+    size_t trace_limit_ = ParseTrace::UNLIMITED;
+    bool build_ast_ = false;
+    bool recover_ = false;
     
-    std::vector<int> state_stack_;
-    std::vector<std::pair<Symbol, std::string>> symbol_stack_;
+    std::vector<StateNum> state_stack_;
+    std::vector<NodeInd> node_stack_;   // узлы дерева символов стека, только при build_ast_
+
+    // По состоянию: терминалы, на которых из него можно восстановиться (sync_known_ - уже посчитано)
+    std::vector<TerminalMask> sync_masks_;
+    std::vector<bool> sync_known_;
     
-    std::string stackToString() const;
+    std::string stackToString(const std::vector<Symbol>& stack) const;
     std::string inputToString(const std::vector<lexer::Token>& tokens, size_t pos) const;
-    std::string actionToString(const ParseAction& action) const;
+    std::string actionToString(const ParseStep& step) const;
+    std::string maskToString(TerminalMask mask) const;
+
+    void applyStep(std::vector<Symbol>& stack, const ParseStep& step) const;
     
-    bool doReduce(const ParseAction& action);
+    // ast == nullptr - дерево не строится, line - строка предпросмотра (для узла эпсилон-правила)
+    bool doReduce(const ParseAction& action, int line, Ast* ast);
     
-    bool doShift(
-        const ParseAction& action, const std::vector<lexer::Token>& tokens, size_t& token_pos
+    bool doShift(const ParseAction& action, const lexer::Token& token, Ast* ast);
+
+    // Терминалы a, для которых у state есть goto по нетерминалу A, a из FOLLOW(A)
+    // и после goto действие по a - не ошибка
+    TerminalMask syncMask(StateNum state);
+
+    // Панический режим: токены пропускаются до терминала из syncMask какого-нибудь состояния стека
+    // (skip_current - текущий пропускается всегда), стек снимается до ближайшего такого состояния
+    // и на него кладётся goto по A. Возвращает A или nullopt, если вход кончился раньше
+    std::optional<Symbol> recover(
+        lexer::TokenStream& tokens, 
+        const lexer::Token*& token, 
+        size_t& token_pos, 
+        bool skip_current
     );
 };
 
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "syntaxer/ParsingTable.hpp"
+
+namespace slr {
+namespace syntaxer {
+
+// Переходы GOTO одного состояния: (номер нетерминала от NT_START, целевое состояние)
+using GotoRow = std::vector<std::pair<size_t, GotoCell>>;
+
+// Сжатие плотной ACTION (states x TERMINAL_COUNT) и разреженной GOTO. constexpr, чтобы
+// этим же кодом сжимать таблицу встроенной грамматики при компиляции
+constexpr CompressedTables compressTables(const std::vector<ActionCell>& action, const std::vector<GotoRow>& goto_rows) {
+    const size_t state_count = goto_rows.size();
+    const ActionCell error_cell = ParseAction::error().pack();
+
+    CompressedTables result;
+    result.lookahead_mask.assign(state_count, 0);
+    result.default_action.assign(state_count, error_cell);
+    result.action_row.assign(state_count, 0);
+
+    // reduce по умолчанию - самый частый reduce строки, он убирается из строки.
+    // Маска оставляет прежние ошибки ошибками
+    std::vector<ActionCell> rows(action);
+
+    for (size_t state = 0; state < state_count; ++state) {
+        ActionCell* row = rows.data() + state * TERMINAL_COUNT;
+        size_t best_count = 0;
+
+        for (size_t term = 0; term < TERMINAL_COUNT; ++term) {
+            if (row[term] == error_cell) {
+                continue;
+            }
+            result.lookahead_mask[state] |= TerminalMask{1} << term;
+
+            if (ParseAction::cellType(row[term]) == ActionType::REDUCE) {
+                const size_t count = static_cast<size_t>(std::count(row, row + TERMINAL_COUNT, row[term]));
+                if (count > best_count) {
+                    best_count = count;
+                    result.default_action[state] = row[term];
+                }
+            }
+        }
+
+        if (best_count != 0) {
+            std::replace(row, row + TERMINAL_COUNT, result.default_action[state], error_cell);
+        }
+    }
+
+    // Одинаковые строки - один раз: сортировка номеров состояний по содержимому строки
+    std::vector<size_t> order(state_count);
+    for (size_t state = 0; state < state_count; ++state) {
+        order[state] = state;
+    }
+
+    auto rowLess = [&](size_t lhs, size_t rhs) {
+        return std::lexicographical_compare(
+            rows.begin() + lhs * TERMINAL_COUNT, rows.begin() + (lhs + 1) * TERMINAL_COUNT,
+            rows.begin() + rhs * TERMINAL_COUNT, rows.begin() + (rhs + 1) * TERMINAL_COUNT
+        );
+    };
+    std::sort(order.begin(), order.end(), rowLess);
+
+    for (size_t ind = 0; ind < state_count; ++ind) {
+        const size_t state = order[ind];
+        if (ind == 0 || rowLess(order[ind - 1], state)) {
+            result.action_rows.insert(
+                result.action_rows.end(),
+                rows.begin() + state * TERMINAL_COUNT, rows.begin() + (state + 1) * TERMINAL_COUNT
+            );
+        }
+        result.action_row[state] = static_cast<uint32_t>(result.action_rows.size() / TERMINAL_COUNT - 1);
+    }
+
+    // GOTO гребёнкой: строки от самых заполненных укладываются в первое место, где все их ячейки свободны
+    constexpr uint32_t FREE = std::numeric_limits<uint32_t>::max();
+
+    result.goto_base.assign(state_count, 0);
+
+    std::vector<size_t> by_size(state_count);
+    for (size_t state = 0; state < state_count; ++state) {
+        by_size[state] = state;
+    }
+    // stable_sort не constexpr, поэтому равные по размеру строки упорядочены номером состояния
+    std::sort(by_size.begin(), by_size.end(), [&](size_t lhs, size_t rhs) {
+        if (goto_rows[lhs].size() != goto_rows[rhs].size()) {
+            return goto_rows[lhs].size() > goto_rows[rhs].size();
+        }
+        return lhs < rhs;
+    });
+
+    size_t first_free = 0;
+
+    for (size_t state : by_size) {
+        const GotoRow& row = goto_rows[state];
+        if (row.empty()) {
+            break;
+        }
+
+        size_t min_col = row.front().first;
+        for (const auto& [col, target] : row) {
+            min_col = std::min(min_col, col);
+        }
+
+        size_t base = (first_free > min_col) ? first_free - min_col : 0;
+        while (true) {
+            bool fits = true;
+            for (const auto& [col, target] : row) {
+                if (base + col < result.goto_check.size() && result.goto_check[base + col] != FREE) {
+                    fits = false;
+                    break;
+                }
+            }
+            if (fits) {
+                break;
+            }
+            ++base;
+        }
+
+        for (const auto& [col, target] : row) {
+            if (base + col >= result.goto_check.size()) {
+                result.goto_check.resize(base + col + 1, FREE);
+                result.goto_next.resize(base + col + 1, ParsingTable::GOTO_NONE);
+            }
+            result.goto_check[base + col] = static_cast<uint32_t>(state);
+            result.goto_next[base + col] = target;
+        }
+        result.goto_base[state] = static_cast<uint32_t>(base);
+
+        while (first_free < result.goto_check.size() && result.goto_check[first_free] != FREE) {
+            ++first_free;
+        }
+    }
+
+    return result;
+}
+
+}
+}
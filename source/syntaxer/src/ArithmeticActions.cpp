@@ -0,0 +1,37 @@
+#include "syntaxer/ArithmeticActions.hpp"
+
+#include <charconv>
+
+namespace slr {
+namespace syntaxer {
+
+ArithmeticActions::ArithmeticActions(const Bindings& variables)
+    :   variables_(variables)
+{}
+
+std::optional<double> ArithmeticActions::shift(const lexer::Token& token) const {
+    switch (token.type) {
+        case lexer::TokenType::NUMBER:
+            return numberValue(token.value);
+
+        case lexer::TokenType::ID: {
+            const auto variable = variables_.find(token.value);
+            if (variable == variables_.end()) {
+                return std::nullopt;
+            }
+            return variable->second;
+        }
+
+        default:
+            return 0.0;
+    }
+}
+
+double ArithmeticActions::numberValue(std::string_view number) noexcept {
+    double value = 0;
+    std::from_chars(number.data(), number.data() + number.size(), value);
+    return value;
+}
+
+}
+}
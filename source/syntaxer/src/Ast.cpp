@@ -0,0 +1,95 @@
+#include "syntaxer/Ast.hpp"
+
+namespace slr {
+namespace syntaxer {
+
+NodeInd Ast::addLeaf(Symbol terminal, std::string_view text, int line) {
+    // токены ссылаются на буфер лексера, поэтому текст копируется в дерево
+    nodes_.push_back({
+        terminal,
+        AstNode::PROD_NONE,
+        static_cast<uint32_t>(text_.size()),
+        static_cast<uint32_t>(text.size()),
+        line
+    });
+    text_.append(text);
+
+    return static_cast<NodeInd>(nodes_.size() - 1);
+}
+
+NodeInd Ast::addNode(Symbol head, size_t prod_ind, std::span<const NodeInd> children, int line) {
+    nodes_.push_back({
+        head,
+        static_cast<uint32_t>(prod_ind),
+        static_cast<uint32_t>(children_.size()),
+        static_cast<uint32_t>(children.size()),
+        children.empty() ? line : nodes_[children.front()].line
+    });
+    children_.insert(children_.end(), children.begin(), children.end());
+
+    return static_cast<NodeInd>(nodes_.size() - 1);
+}
+
+const AstNode& Ast::operator[](NodeInd node) const noexcept {
+    return nodes_[node];
+}
+
+std::span<const NodeInd> Ast::getChildren(NodeInd node) const noexcept {
+    const AstNode& ast_node = nodes_[node];
+    if (ast_node.prod_ind == AstNode::PROD_NONE) {
+        return {};
+    }
+    return {children_.data() + ast_node.first, ast_node.count};
+}
+
+std::string_view Ast::getText(NodeInd node) const noexcept {
+    const AstNode& ast_node = nodes_[node];
+    if (ast_node.prod_ind != AstNode::PROD_NONE) {
+        return {};
+    }
+    return std::string_view(text_).substr(ast_node.first, ast_node.count);
+}
+
+bool    Ast::isLeaf     (NodeInd node)  const noexcept { return nodes_[node].prod_ind == AstNode::PROD_NONE; }
+void    Ast::setRoot    (NodeInd node)        noexcept { root_ = node; }
+NodeInd Ast::getRoot    ()              const noexcept { return root_; }
+size_t  Ast::size       ()              const noexcept { return nodes_.size(); }
+bool    Ast::empty      ()              const noexcept { return root_ == NODE_NONE; }
+
+void Ast::clear() noexcept {
+    nodes_.clear();
+    children_.clear();
+    text_.clear();
+    root_ = NODE_NONE;
+}
+
+void Ast::print(const Grammar& grammar, std::ostream& out) const {
+    out << "\n===AST===\n";
+
+    if (empty()) {
+        out << "(empty)\n";
+        return;
+    }
+
+    // обход в глубину без рекурсии: (узел, глубина)
+    std::vector<std::pair<NodeInd, size_t>> stack = {{root_, 0}};
+
+    while (!stack.empty()) {
+        const auto [node, depth] = stack.back();
+        stack.pop_back();
+
+        out << std::string(depth * 2, ' ') << grammar.getSymbolStr(nodes_[node].symbol);
+        if (isLeaf(node)) {
+            out << " '" << getText(node) << "'";
+        }
+        out << "\n";
+
+        const auto children = getChildren(node);
+        for (auto child = children.rbegin(); child != children.rend(); ++child) {
+            stack.emplace_back(*child, depth + 1);
+        }
+    }
+}
+
+}
+}
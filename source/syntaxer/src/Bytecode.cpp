@@ -0,0 +1,182 @@
+#include "syntaxer/Bytecode.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace slr {
+namespace syntaxer {
+
+namespace {
+
+const char* opCodeStr(OpCode op) {
+    switch (op) {
+        case OpCode::LOAD_CONST:    return "LOAD_CONST";
+        case OpCode::LOAD_VAR:      return "LOAD_VAR";
+        case OpCode::ADD:           return "ADD";
+        case OpCode::SUB:           return "SUB";
+        case OpCode::MUL:           return "MUL";
+        case OpCode::DIV:           return "DIV";
+        case OpCode::ADD_K:         return "ADD_K";
+        case OpCode::SUB_K:         return "SUB_K";
+        case OpCode::RSUB_K:        return "RSUB_K";
+        case OpCode::MUL_K:         return "MUL_K";
+        case OpCode::DIV_K:         return "DIV_K";
+        case OpCode::RDIV_K:        return "RDIV_K";
+        default:                    return "UNKNOWN";
+    }
+}
+
+}
+
+void Bytecode::emit(OpCode op, uint32_t arg) {
+    code_.push_back({op, arg});
+
+    // LOAD кладёт значение, бинарная операция снимает два и кладёт одно, *_K меняет вершину
+    if (op == OpCode::LOAD_CONST || op == OpCode::LOAD_VAR) {
+        ++depth_;
+        max_depth_ = std::max(max_depth_, depth_);
+    }
+    else if (op == OpCode::ADD || op == OpCode::SUB || op == OpCode::MUL || op == OpCode::DIV) {
+        assert(depth_ >= 2);
+        --depth_;
+    }
+}
+
+uint32_t Bytecode::addConstant(double value) {
+    constants_.push_back(value);
+    return static_cast<uint32_t>(constants_.size() - 1);
+}
+
+uint32_t Bytecode::addVariable(std::string_view name, int line) {
+    const auto found = std::find(variable_names_.begin(), variable_names_.end(), name);
+    if (found != variable_names_.end()) {
+        return static_cast<uint32_t>(found - variable_names_.begin());
+    }
+
+    variable_names_.emplace_back(name);
+    variable_lines_.push_back(line);
+    return static_cast<uint32_t>(variable_names_.size() - 1);
+}
+
+std::optional<std::vector<double>> Bytecode::bind(const Bindings& bindings) const {
+    std::vector<double> values;
+    values.reserve(variable_names_.size());
+
+    for (const auto& name : variable_names_) {
+        const auto variable = bindings.find(name);
+        if (variable == bindings.end()) {
+            return std::nullopt;
+        }
+        values.push_back(variable->second);
+    }
+
+    return values;
+}
+
+double Bytecode::evaluate(std::span<const double> variables, std::vector<double>& stack) const {
+    assert(variables.size() == variable_names_.size());
+
+    stack.resize(max_depth_);
+    // top - за вершиной стека
+    double* top = stack.data();
+
+    for (const Instruction& instr : code_) {
+        switch (instr.op) {
+            case OpCode::LOAD_CONST:    *top++ = constants_[instr.arg];             break;
+            case OpCode::LOAD_VAR:      *top++ = variables[instr.arg];              break;
+            case OpCode::ADD:           top[-2] += top[-1]; --top;                  break;
+            case OpCode::SUB:           top[-2] -= top[-1]; --top;                  break;
+            case OpCode::MUL:           top[-2] *= top[-1]; --top;                  break;
+            case OpCode::DIV:           top[-2] /= top[-1]; --top;                  break;
+            case OpCode::ADD_K:         top[-1] += constants_[instr.arg];           break;
+            case OpCode::SUB_K:         top[-1] -= constants_[instr.arg];           break;
+            case OpCode::RSUB_K:        top[-1] = constants_[instr.arg] - top[-1];  break;
+            case OpCode::MUL_K:         top[-1] *= constants_[instr.arg];           break;
+            case OpCode::DIV_K:         top[-1] /= constants_[instr.arg];           break;
+            case OpCode::RDIV_K:        top[-1] = constants_[instr.arg] / top[-1];  break;
+        }
+    }
+
+    return top[-1];
+}
+
+const std::vector<Instruction>& Bytecode::getCode           ()              const noexcept { return code_; }
+const std::vector<std::string>& Bytecode::getVariableNames  ()              const noexcept { return variable_names_; }
+int                             Bytecode::getVariableLine   (uint32_t slot) const noexcept { return variable_lines_[slot]; }
+size_t                          Bytecode::getMaxDepth       ()              const noexcept { return max_depth_; }
+
+void Bytecode::clear() noexcept {
+    code_.clear();
+    constants_.clear();
+    variable_names_.clear();
+    variable_lines_.clear();
+    depth_ = 0;
+    max_depth_ = 0;
+}
+
+void Bytecode::print(std::ostream& out) const {
+    out << "\n===Bytecode===\n";
+
+    for (size_t instr_ind = 0; instr_ind < code_.size(); ++instr_ind) {
+        const Instruction& instr = code_[instr_ind];
+        out << instr_ind << ": " << opCodeStr(instr.op);
+
+        if (instr.op == OpCode::LOAD_VAR) {
+            out << " " << variable_names_[instr.arg];
+        }
+        else if (instr.op != OpCode::ADD && instr.op != OpCode::SUB
+              && instr.op != OpCode::MUL && instr.op != OpCode::DIV) {
+            out << " " << constants_[instr.arg];
+        }
+        out << "\n";
+    }
+}
+
+BytecodeCompiler::BytecodeCompiler(Bytecode& program)
+    :   program_(program)
+{}
+
+std::optional<BytecodeCompiler::Operand> BytecodeCompiler::shift(const lexer::Token& token) {
+    switch (token.type) {
+        case lexer::TokenType::NUMBER:
+            return Operand{true, ArithmeticActions::numberValue(token.value)};
+
+        case lexer::TokenType::ID:
+            program_.emit(OpCode::LOAD_VAR, program_.addVariable(token.value, token.line));
+            return Operand{false, 0};
+
+        default:
+            return Operand{true, 0};
+    }
+}
+
+BytecodeCompiler::Operand BytecodeCompiler::binary(
+    OpCode op, OpCode op_k, OpCode rop_k,
+    const Operand& lhs, const Operand& rhs, double folded
+) {
+    if (lhs.constant && rhs.constant) {
+        return {true, folded};
+    }
+
+    // код неконстантных операндов уже выписан: сначала левый, затем правый
+    if (rhs.constant) {
+        program_.emit(op_k, program_.addConstant(rhs.value));
+    }
+    else if (lhs.constant) {
+        program_.emit(rop_k, program_.addConstant(lhs.value));
+    }
+    else {
+        program_.emit(op);
+    }
+
+    return {false, 0};
+}
+
+void BytecodeCompiler::finish(const Operand& result) {
+    if (result.constant) {
+        program_.emit(OpCode::LOAD_CONST, program_.addConstant(result.value));
+    }
+}
+
+}
+}
@@ -0,0 +1,161 @@
+#include "syntaxer/Bytecode.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace slr {
+namespace syntaxer {
+
+namespace {
+
+#if defined(__AVX2__)
+
+struct Vec {
+    using Reg = __m256d;
+    constexpr inline static size_t WIDTH = 4;
+
+    static Reg  load (const double* p)          noexcept { return _mm256_loadu_pd(p); }
+    static void store(double* p, Reg a)         noexcept { _mm256_storeu_pd(p, a); }
+    static Reg  set1 (double k)                 noexcept { return _mm256_set1_pd(k); }
+    static Reg  add  (Reg a, Reg b)             noexcept { return _mm256_add_pd(a, b); }
+    static Reg  sub  (Reg a, Reg b)             noexcept { return _mm256_sub_pd(a, b); }
+    static Reg  mul  (Reg a, Reg b)             noexcept { return _mm256_mul_pd(a, b); }
+    static Reg  div  (Reg a, Reg b)             noexcept { return _mm256_div_pd(a, b); }
+};
+
+#elif defined(__SSE2__)
+
+struct Vec {
+    using Reg = __m128d;
+    constexpr inline static size_t WIDTH = 2;
+
+    static Reg  load (const double* p)          noexcept { return _mm_loadu_pd(p); }
+    static void store(double* p, Reg a)         noexcept { _mm_storeu_pd(p, a); }
+    static Reg  set1 (double k)                 noexcept { return _mm_set1_pd(k); }
+    static Reg  add  (Reg a, Reg b)             noexcept { return _mm_add_pd(a, b); }
+    static Reg  sub  (Reg a, Reg b)             noexcept { return _mm_sub_pd(a, b); }
+    static Reg  mul  (Reg a, Reg b)             noexcept { return _mm_mul_pd(a, b); }
+    static Reg  div  (Reg a, Reg b)             noexcept { return _mm_div_pd(a, b); }
+};
+
+#endif
+
+// Операции ядер: векторная и скалярная (для хвоста и сборок без SIMD) версии
+struct Add {
+#if defined(__AVX2__) || defined(__SSE2__)
+    static Vec::Reg apply(Vec::Reg a, Vec::Reg b) noexcept { return Vec::add(a, b); }
+#endif
+    static double   apply(double a, double b)     noexcept { return a + b; }
+};
+
+struct Sub {
+#if defined(__AVX2__) || defined(__SSE2__)
+    static Vec::Reg apply(Vec::Reg a, Vec::Reg b) noexcept { return Vec::sub(a, b); }
+#endif
+    static double   apply(double a, double b)     noexcept { return a - b; }
+};
+
+struct Mul {
+#if defined(__AVX2__) || defined(__SSE2__)
+    static Vec::Reg apply(Vec::Reg a, Vec::Reg b) noexcept { return Vec::mul(a, b); }
+#endif
+    static double   apply(double a, double b)     noexcept { return a * b; }
+};
+
+struct Div {
+#if defined(__AVX2__) || defined(__SSE2__)
+    static Vec::Reg apply(Vec::Reg a, Vec::Reg b) noexcept { return Vec::div(a, b); }
+#endif
+    static double   apply(double a, double b)     noexcept { return a / b; }
+};
+
+// lhs[i] = lhs[i] op rhs[i]
+template <typename Op>
+void applyColumns(double* lhs, const double* rhs, size_t count) noexcept {
+    size_t row = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+    for (; row + Vec::WIDTH <= count; row += Vec::WIDTH) {
+        Vec::store(lhs + row, Op::apply(Vec::load(lhs + row), Vec::load(rhs + row)));
+    }
+#endif
+    for (; row < count; ++row) {
+        lhs[row] = Op::apply(lhs[row], rhs[row]);
+    }
+}
+
+// REVERSED == false: col[i] = col[i] op k, иначе col[i] = k op col[i]
+template <typename Op, bool REVERSED>
+void applyConstant(double* col, double k, size_t count) noexcept {
+    size_t row = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+    const Vec::Reg k_reg = Vec::set1(k);
+    for (; row + Vec::WIDTH <= count; row += Vec::WIDTH) {
+        const Vec::Reg value = Vec::load(col + row);
+        Vec::store(col + row, REVERSED ? Op::apply(k_reg, value) : Op::apply(value, k_reg));
+    }
+#endif
+    for (; row < count; ++row) {
+        col[row] = REVERSED ? Op::apply(k, col[row]) : Op::apply(col[row], k);
+    }
+}
+
+}
+
+const std::vector<double>* Columns::find(std::string_view name) const noexcept {
+    const auto found = std::find(names.begin(), names.end(), name);
+    return (found != names.end()) ? &values[found - names.begin()] : nullptr;
+}
+
+void Bytecode::evaluateColumns(
+    std::span<const std::span<const double>> columns,
+    std::span<double> out,
+    std::vector<double>& stack
+) const {
+    assert(columns.size() == variable_names_.size());
+
+    // стек - max_depth_ столбцов по BLOCK_ROWS
+    stack.resize(max_depth_ * BLOCK_ROWS);
+
+    for (size_t block_begin = 0; block_begin < out.size(); block_begin += BLOCK_ROWS) {
+        const size_t rows = std::min(BLOCK_ROWS, out.size() - block_begin);
+        // top - за вершиной стека, вершина - столбец top - BLOCK_ROWS
+        double* top = stack.data();
+
+        for (const Instruction& instr : code_) {
+            switch (instr.op) {
+                case OpCode::LOAD_CONST:
+                    std::fill(top, top + rows, constants_[instr.arg]);
+                    top += BLOCK_ROWS;
+                    break;
+
+                case OpCode::LOAD_VAR:
+                    std::memcpy(top, columns[instr.arg].data() + block_begin, rows * sizeof(double));
+                    top += BLOCK_ROWS;
+                    break;
+
+                case OpCode::ADD:       top -= BLOCK_ROWS; applyColumns<Add>(top - BLOCK_ROWS, top, rows);    break;
+                case OpCode::SUB:       top -= BLOCK_ROWS; applyColumns<Sub>(top - BLOCK_ROWS, top, rows);    break;
+                case OpCode::MUL:       top -= BLOCK_ROWS; applyColumns<Mul>(top - BLOCK_ROWS, top, rows);    break;
+                case OpCode::DIV:       top -= BLOCK_ROWS; applyColumns<Div>(top - BLOCK_ROWS, top, rows);    break;
+                case OpCode::ADD_K:     applyConstant<Add, false>(top - BLOCK_ROWS, constants_[instr.arg], rows); break;
+                case OpCode::SUB_K:     applyConstant<Sub, false>(top - BLOCK_ROWS, constants_[instr.arg], rows); break;
+                case OpCode::RSUB_K:    applyConstant<Sub, true> (top - BLOCK_ROWS, constants_[instr.arg], rows); break;
+                case OpCode::MUL_K:     applyConstant<Mul, false>(top - BLOCK_ROWS, constants_[instr.arg], rows); break;
+                case OpCode::DIV_K:     applyConstant<Div, false>(top - BLOCK_ROWS, constants_[instr.arg], rows); break;
+                case OpCode::RDIV_K:    applyConstant<Div, true> (top - BLOCK_ROWS, constants_[instr.arg], rows); break;
+            }
+        }
+
+        std::memcpy(out.data() + block_begin, top - BLOCK_ROWS, rows * sizeof(double));
+    }
+}
+
+}
+}
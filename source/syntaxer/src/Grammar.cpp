@@ -1,6 +1,7 @@
 #include "syntaxer/Grammar.hpp"
 
 #include "lexer/tokens.hpp"
+#include <algorithm>
 #include <iostream>
 
 namespace slr {
@@ -8,115 +9,212 @@ namespace syntaxer {
 
 Grammar::Grammar() {
     
-    productions_ = {
-        {Symbol::NT_START,  {Symbol::NT_SUM},                                       "<start> -> <sum>"},
-        {Symbol::NT_SUM,    {Symbol::NT_SUM, Symbol::PLUS, Symbol::NT_MUL},         "<sum> -> <sum> '+' <mul>"},
-        {Symbol::NT_SUM,    {Symbol::NT_SUM, Symbol::MINUS, Symbol::NT_MUL},        "<sum> -> <sum> '-' <mul>"},
-        {Symbol::NT_SUM,    {Symbol::NT_MUL},                                       "<sum> -> <mul>"},
-        {Symbol::NT_MUL,    {Symbol::NT_MUL, Symbol::MUL, Symbol::NT_BRAKETS},      "<mul> -> <mul> '*' <brakets>"},
-        {Symbol::NT_MUL,    {Symbol::NT_MUL, Symbol::DIV, Symbol::NT_BRAKETS},      "<mul> -> <mul> '/' <brakets>"},
-        {Symbol::NT_MUL,    {Symbol::NT_BRAKETS},                                   "<mul> -> <brakets>"},
-        {Symbol::NT_BRAKETS,{Symbol::LBRACKET, Symbol::NT_SUM, Symbol::RBRACKET},   "<brakets> -> '(' <sum> ')'"},
-        {Symbol::NT_BRAKETS,{Symbol::NUMBER},                                       "<brakets> -> NUM"},
-        {Symbol::NT_BRAKETS,{Symbol::ID},                                           "<brakets> -> ID"},
-    };
+    productions_.reserve(BUILTIN_PRODUCTIONS.size());
+    for (const auto& prod : BUILTIN_PRODUCTIONS) {
+        productions_.push_back({
+            prod.head, 
+            std::vector<Symbol>(prod.body.begin(), prod.body.begin() + prod.body_size), 
+            std::string(prod.name)
+        });
+    }
+    non_terminal_names_ = {"NT_START", "NT_SUM", "NT_MUL", "NT_BRAKETS"};
     
     buildFirstSets();
     buildFollowSets();
 }
 
-void Grammar::buildFollowSets() {
-    follow_sets_.resize(static_cast<size_t>(Symbol::COUNT));
-    
-    follow_sets_[static_cast<size_t>(Symbol::NT_START)].insert(Symbol::END_OF_FILE);
-    
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        
-        for (const auto& prod : productions_) {
-            const auto& body = prod.body;
-            
-            for (size_t sym_ind = 0; sym_ind < body.size(); ++sym_ind) {
-                if (isTerminal(body[sym_ind])) {
-                    continue;
-                }
-                
-                std::vector<Symbol> to_add;
-                
-                if (sym_ind == body.size() - 1) {
-                    const auto& follow_head = follow_sets_[static_cast<size_t>(prod.head)];
-                    to_add.insert(to_add.end(), follow_head.begin(), follow_head.end());
-                }
-                else {
-                    Symbol next_sym = body[sym_ind + 1];
-                    
-                    if (isTerminal(next_sym)) {
-                        to_add.push_back(next_sym);
-                    }
-                    else {
-                        const auto& first_next = first_sets_[static_cast<size_t>(next_sym)];
-                        to_add.insert(to_add.end(), first_next.begin(), first_next.end());
-                    }
-                }
+namespace {
+
+// Очередь символов без повторов: символ, уже стоящий в очереди, второй раз не добавляется
+class SymbolWorklist {
+
+public:
 
-                auto& follow_current = follow_sets_[static_cast<size_t>(body[sym_ind])];
-                const size_t prev_size = follow_current.size(); 
+    explicit SymbolWorklist(size_t symbol_count)
+        :   queued_(symbol_count, false)
+    {}
 
-                follow_current.insert(to_add.begin(), to_add.end());
-                changed = (prev_size != follow_current.size());
+    void push(size_t sym_ind) {
+        if (!queued_[sym_ind]) {
+            queued_[sym_ind] = true;
+            queue_.push_back(sym_ind);
+        }
+    }
+
+    bool empty() const noexcept {
+        return head_ == queue_.size();
+    }
+
+    size_t pop() {
+        const size_t sym_ind = queue_[head_++];
+        queued_[sym_ind] = false;
+        return sym_ind;
+    }
+
+private:
+
+    std::vector<size_t> queue_;
+    size_t head_ = 0;
+    std::vector<bool> queued_;
+};
+
+// sets[to] |= sets[from] по всем рёбрам, пока множества меняются. 
+// Каждое множество растёт не больше TokenType::COUNT раз, поэтому рёбра просматриваются O(E * COUNT) раз
+void propagate(
+    std::vector<TerminalMask>& sets, 
+    const std::vector<std::vector<size_t>>& edges
+) {
+    SymbolWorklist worklist(sets.size());
+    for (size_t sym_ind = 0; sym_ind < sets.size(); ++sym_ind) {
+        if (sets[sym_ind] != 0 && !edges[sym_ind].empty()) {
+            worklist.push(sym_ind);
+        }
+    }
+
+    while (!worklist.empty()) {
+        const size_t from = worklist.pop();
+        for (size_t to : edges[from]) {
+            const TerminalMask merged = sets[to] | sets[from];
+            if (merged != sets[to]) {
+                sets[to] = merged;
+                worklist.push(to);
+            }
+        }
+    }
+}
+
+TerminalMask terminalBit(Symbol terminal) {
+    return TerminalMask{1} << static_cast<size_t>(terminal);
+}
+
+}
+
+void Grammar::buildNullable() {
+    nullable_.assign(getSymbolCount(), false);
+
+    // у продукции - число ещё не обнулённых символов тела, у символа - продукции, где он встречается
+    std::vector<size_t> remaining(productions_.size());
+    std::vector<std::vector<size_t>> uses(getSymbolCount());
+    SymbolWorklist worklist(getSymbolCount());
+
+    for (size_t prod_ind = 0; prod_ind < productions_.size(); ++prod_ind) {
+        const auto& prod = productions_[prod_ind];
+        remaining[prod_ind] = prod.body.size();
+        for (Symbol sym : prod.body) {
+            uses[static_cast<size_t>(sym)].push_back(prod_ind);
+        }
+        if (prod.body.empty() && !nullable_[static_cast<size_t>(prod.head)]) {
+            nullable_[static_cast<size_t>(prod.head)] = true;
+            worklist.push(static_cast<size_t>(prod.head));
+        }
+    }
+
+    while (!worklist.empty()) {
+        for (size_t prod_ind : uses[worklist.pop()]) {
+            const size_t head = static_cast<size_t>(productions_[prod_ind].head);
+            if (--remaining[prod_ind] == 0 && !nullable_[head]) {
+                nullable_[head] = true;
+                worklist.push(head);
             }
         }
     }
 }
 
 void Grammar::buildFirstSets() {
-    first_sets_.resize(static_cast<size_t>(Symbol::COUNT));
+    buildNullable();
+
+    first_sets_.assign(getSymbolCount(), 0);
     
     for (int term_sym = 1; term_sym < static_cast<int>(slr::lexer::TokenType::COUNT); ++term_sym) {
-        Symbol s = static_cast<Symbol>(term_sym);
-        first_sets_[term_sym].insert(s);
+        first_sets_[term_sym] = terminalBit(static_cast<Symbol>(term_sym));
+    }
+
+    // FIRST(A) включает FIRST(X) для каждого X из обнуляемого префикса тела A -> ... X ...
+    std::vector<std::vector<size_t>> edges(getSymbolCount());
+
+    for (const auto& prod : productions_) {
+        const size_t head = static_cast<size_t>(prod.head);
+
+        for (Symbol sym : prod.body) {
+            if (isTerminal(sym)) {
+                first_sets_[head] |= terminalBit(sym);
+            }
+            else if (sym != prod.head) {
+                edges[static_cast<size_t>(sym)].push_back(head);
+            }
+
+            if (!nullable_[static_cast<size_t>(sym)]) {
+                break;
+            }
+        }
     }
+
+    propagate(first_sets_, edges);
+}
+
+void Grammar::buildFollowSets() {
+    follow_sets_.assign(getSymbolCount(), 0);
     
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        
-        for (const auto& prod : productions_) {
-            Symbol first_body = prod.body[0];
-            auto& first_head = first_sets_[static_cast<size_t>(prod.head)];
-            
-            const auto& first_body_set = first_sets_[static_cast<size_t>(first_body)];
-            for (Symbol first_body_sym : first_body_set) {
-                if (first_head.insert(first_body_sym).second) {
-                    changed = true;
+    follow_sets_[static_cast<size_t>(Symbol::NT_START)] = terminalBit(Symbol::END_OF_FILE);
+
+    // Для A -> alpha X beta: FOLLOW(X) включает FIRST(beta) сразу, а FOLLOW(A) - ребром, если beta обнуляемо
+    std::vector<std::vector<size_t>> edges(getSymbolCount());
+
+    for (const auto& prod : productions_) {
+        TerminalMask first_suffix = 0;
+        bool suffix_nullable = true;
+
+        for (auto sym = prod.body.rbegin(); sym != prod.body.rend(); ++sym) {
+            const size_t sym_ind = static_cast<size_t>(*sym);
+
+            if (isNonTerminal(*sym)) {
+                follow_sets_[sym_ind] |= first_suffix;
+                if (suffix_nullable && *sym != prod.head) {
+                    edges[static_cast<size_t>(prod.head)].push_back(sym_ind);
                 }
             }
+
+            if (nullable_[sym_ind]) {
+                first_suffix |= first_sets_[sym_ind];
+            }
+            else {
+                first_suffix = first_sets_[sym_ind];
+                suffix_nullable = false;
+            }
         }
     }
+
+    propagate(follow_sets_, edges);
 }
 
 void Grammar::print(std::ostream& out) const {
     out << "\n=== Grammar Info ===\n";
     out << "\n=== FIRST Sets ===\n";
-    for (int i = 0; i < static_cast<int>(Symbol::COUNT); ++i) {
+    for (int i = 0; i < static_cast<int>(getSymbolCount()); ++i) {
         Symbol sym = static_cast<Symbol>(i);
 
         out << "FIRST(" << Grammar::getSymbolStr(sym) << ") = { ";
-        for (auto sym : getFirst(sym)) {
-            out << "'"<< Grammar::getSymbolStr(sym) << "' ";
+        for (int term = 1; term < static_cast<int>(lexer::TokenType::COUNT); ++term) {
+            if (getFirst(sym) & terminalBit(static_cast<Symbol>(term))) {
+                out << "'"<< Grammar::getSymbolStr(static_cast<Symbol>(term)) << "' ";
+            }
+        }
+        if (isNullable(sym)) {
+            out << "'EPSILON' ";
         }
         out << "}\n";
         
     }
     
     out << "\n=== FOLLOW Sets ===\n";
-    for (int i = 0; i < static_cast<int>(Symbol::COUNT); ++i) {
+    for (int i = 0; i < static_cast<int>(getSymbolCount()); ++i) {
         Symbol sym = static_cast<Symbol>(i);
 
         out << "FOLLOW(" << Grammar::getSymbolStr(sym) << ") = { ";
-        for (auto follow_sym : getFollow(sym)) {
-            out << Grammar::getSymbolStr(follow_sym) << " ";
+        for (int term = 1; term < static_cast<int>(lexer::TokenType::COUNT); ++term) {
+            if (getFollow(sym) & terminalBit(static_cast<Symbol>(term))) {
+                out << Grammar::getSymbolStr(static_cast<Symbol>(term)) << " ";
+            }
         }
         out << "}\n";
         
@@ -136,15 +234,67 @@ std::string Grammar::productionString(size_t prod_ind) const noexcept {
     return productions_[prod_ind].name; 
 }
 
-const std::unordered_set<Symbol>& Grammar::getFollow(Symbol non_terminal) const {
+uint64_t Grammar::hash() const noexcept {
+    // FNV-1a
+    constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+    constexpr uint64_t FNV_PRIME  = 1099511628211ull;
+
+    uint64_t result = FNV_OFFSET;
+    auto mix = [&](uint64_t value) {
+        for (int byte = 0; byte < 8; ++byte) {
+            result ^= (value >> (byte * 8)) & 0xFF;
+            result *= FNV_PRIME;
+        }
+    };
+
+    mix(getSymbolCount());
+    mix(productions_.size());
+    for (const auto& prod : productions_) {
+        mix(static_cast<uint64_t>(prod.head));
+        mix(prod.body.size());
+        for (Symbol sym : prod.body) {
+            mix(static_cast<uint64_t>(sym));
+        }
+    }
+
+    return result;
+}
+
+bool Grammar::isBuiltin() const noexcept {
+    if (productions_.size() != BUILTIN_PRODUCTIONS.size() 
+        || getSymbolCount() != static_cast<size_t>(Symbol::COUNT)) {
+        return false;
+    }
+
+    for (size_t prod_ind = 0; prod_ind < productions_.size(); ++prod_ind) {
+        const auto& prod = productions_[prod_ind];
+        const auto& builtin = BUILTIN_PRODUCTIONS[prod_ind];
+
+        if (prod.head != builtin.head 
+            || !std::equal(prod.body.begin(), prod.body.end(), builtin.body.begin(), builtin.body.begin() + builtin.body_size)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+TerminalMask Grammar::getFollow(Symbol non_terminal) const noexcept {
     return follow_sets_[static_cast<size_t>(non_terminal)];
 }
-const std::unordered_set<Symbol>& Grammar::getFirst(Symbol symbol) const {
+TerminalMask Grammar::getFirst(Symbol symbol) const noexcept {
     return first_sets_[static_cast<size_t>(symbol)];
 }
+bool Grammar::isNullable(Symbol symbol) const noexcept {
+    return nullable_[static_cast<size_t>(symbol)];
+}
+
+size_t Grammar::getSymbolCount() const noexcept {
+    return static_cast<size_t>(Symbol::NT_START) + non_terminal_names_.size();
+}
 
 bool Grammar::isNonTerminal(Symbol s) {
-    return s >= Symbol::NT_START && s < Symbol::COUNT;
+    return s >= Symbol::NT_START;
 }
 
 bool Grammar::isTerminal(Symbol s) {
@@ -160,7 +310,11 @@ Symbol Grammar::fromTokenType(lexer::TokenType token_type) {
 
 
 #define CASE_RET_STR(type) case Symbol::type: { return #type; }
-std::string Grammar::getSymbolStr(Symbol s) {
+std::string Grammar::getSymbolStr(Symbol s) const {
+    if (isNonTerminal(s) && static_cast<size_t>(s) < getSymbolCount()) {
+        return non_terminal_names_[static_cast<size_t>(s) - static_cast<size_t>(Symbol::NT_START)];
+    }
+
     switch(s) {
         CASE_RET_STR(END_OF_FILE)
         CASE_RET_STR(NUMBER)
@@ -171,10 +325,6 @@ std::string Grammar::getSymbolStr(Symbol s) {
         CASE_RET_STR(DIV)
         CASE_RET_STR(LBRACKET)
         CASE_RET_STR(RBRACKET)
-        CASE_RET_STR(NT_START)
-        CASE_RET_STR(NT_SUM)
-        CASE_RET_STR(NT_MUL)
-        CASE_RET_STR(NT_BRAKETS)
         default: {
             return "UNKNOWN";
         }
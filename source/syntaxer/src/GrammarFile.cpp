@@ -0,0 +1,216 @@
+#include "syntaxer/Grammar.hpp"
+
+#include <cctype>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "utils/common.hpp"
+#include "utils/MappedFile.hpp"
+
+namespace slr {
+namespace syntaxer {
+
+namespace {
+
+struct GrammarToken {
+    std::string_view text;
+    size_t line;
+};
+
+// Как терминал записывается в имени продукции
+std::string_view terminalSpelling(Symbol terminal) {
+    switch (terminal) {
+        case Symbol::NUMBER:    return "NUM";
+        case Symbol::ID:        return "ID";
+        case Symbol::PLUS:      return "'+'";
+        case Symbol::MINUS:     return "'-'";
+        case Symbol::MUL:       return "'*'";
+        case Symbol::DIV:       return "'/'";
+        case Symbol::LBRACKET:  return "'('";
+        case Symbol::RBRACKET:  return "')'";
+        default:                return "UNKNOWN";
+    }
+}
+
+const std::unordered_map<std::string_view, Symbol>& terminalsByName() {
+    static const std::unordered_map<std::string_view, Symbol> terminals = {
+        {"NUM",     Symbol::NUMBER},    {"NUMBER",      Symbol::NUMBER},
+        {"ID",      Symbol::ID},
+        {"'+'",     Symbol::PLUS},      {"\"+\"",       Symbol::PLUS},      {"PLUS",        Symbol::PLUS},
+        {"'-'",     Symbol::MINUS},     {"\"-\"",       Symbol::MINUS},     {"MINUS",       Symbol::MINUS},
+        {"'*'",     Symbol::MUL},       {"\"*\"",       Symbol::MUL},       {"MUL",         Symbol::MUL},
+        {"'/'",     Symbol::DIV},       {"\"/\"",       Symbol::DIV},       {"DIV",         Symbol::DIV},
+        {"'('",     Symbol::LBRACKET},  {"\"(\"",       Symbol::LBRACKET},  {"LBRACKET",    Symbol::LBRACKET},
+        {"')'",     Symbol::RBRACKET},  {"\")\"",       Symbol::RBRACKET},  {"RBRACKET",    Symbol::RBRACKET},
+    };
+    return terminals;
+}
+
+bool isNonTerminalToken(std::string_view text) {
+    return text.size() > 2 && text.front() == '<' && text.back() == '>';
+}
+
+// Разбивает текст на <нетерминалы>, 'литералы', "::=", "|" и слова. # - комментарий до конца строки
+std::vector<GrammarToken> tokenize(std::string_view text, const std::string& filename) {
+    std::vector<GrammarToken> tokens;
+    size_t line = 1;
+    size_t pos = 0;
+
+    while (pos < text.size()) {
+        const char c = text[pos];
+
+        if (c == '\n') {
+            ++line;
+            ++pos;
+            continue;
+        }
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            ++pos;
+            continue;
+        }
+        if (c == '#') {
+            while (pos < text.size() && text[pos] != '\n') {
+                ++pos;
+            }
+            continue;
+        }
+
+        size_t end = pos + 1;
+        if (c == '\'' || c == '"' || c == '<') {
+            const char closing = (c == '<') ? '>' : c;
+            while (end < text.size() && text[end] != closing && text[end] != '\n') {
+                ++end;
+            }
+            if (end == text.size() || text[end] != closing) {
+                utils::THROW(filename + ":" + std::to_string(line) + ": unterminated '" + std::string(1, c) + "'");
+            }
+            ++end;
+        }
+        else {
+            while (end < text.size() && !std::isspace(static_cast<unsigned char>(text[end]))) {
+                ++end;
+            }
+        }
+
+        tokens.push_back({text.substr(pos, end - pos), line});
+        pos = end;
+    }
+
+    return tokens;
+}
+
+}
+
+Grammar::Grammar(const std::string& grammar_filename) {
+    const utils::MappedFile file(grammar_filename);
+    const std::vector<GrammarToken> tokens = tokenize(file.view(), grammar_filename);
+
+    auto fail = [&](size_t line, const std::string& message) {
+        utils::THROW(grammar_filename + ":" + std::to_string(line) + ": " + message);
+    };
+
+    std::unordered_map<std::string_view, Symbol> non_terminals;
+    std::unordered_set<Symbol> defined;
+    std::vector<GrammarToken> first_use;
+
+    non_terminal_names_ = {"NT_START"};
+
+    auto nonTerminal = [&](const GrammarToken& token) -> Symbol {
+        const std::string_view name = token.text.substr(1, token.text.size() - 2);
+        if (name == "start") {
+            fail(token.line, "'<start>' is reserved for the augmented start symbol");
+        }
+
+        auto [it, inserted] = non_terminals.try_emplace(name, static_cast<Symbol>(getSymbolCount()));
+        if (inserted) {
+            std::string symbol_name = "NT_";
+            for (char c : name) {
+                symbol_name += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+            non_terminal_names_.push_back(std::move(symbol_name));
+            first_use.push_back(token);
+        }
+        return it->second;
+    };
+
+    auto isRuleStart = [&](size_t pos) {
+        return pos + 1 < tokens.size() && isNonTerminalToken(tokens[pos].text) && tokens[pos + 1].text == "::=";
+    };
+
+    // Продукция 0 - пополняющая <start> -> <первый нетерминал>, заполняется после разбора
+    productions_.push_back({Symbol::NT_START, {}, ""});
+
+    size_t pos = 0;
+    while (pos < tokens.size()) {
+        if (!isRuleStart(pos)) {
+            fail(tokens[pos].line, "expected '<name> ::=', got '" + std::string(tokens[pos].text) + "'");
+        }
+
+        const Symbol head = nonTerminal(tokens[pos]);
+        const std::string head_str(tokens[pos].text);
+        defined.insert(head);
+        pos += 2;
+
+        Production prod{head, {}, head_str + " ->"};
+
+        while (true) {
+            const bool rule_end = (pos == tokens.size() || isRuleStart(pos));
+
+            if (rule_end || tokens[pos].text == "|") {
+                // пустая альтернатива - эпсилон-правило
+                if (prod.body.empty()) {
+                    prod.name += " EPSILON";
+                }
+                productions_.push_back(std::move(prod));
+                prod = Production{head, {}, head_str + " ->"};
+
+                if (rule_end) {
+                    break;
+                }
+                ++pos;
+                continue;
+            }
+
+            const GrammarToken& token = tokens[pos++];
+
+            if (isNonTerminalToken(token.text)) {
+                prod.body.push_back(nonTerminal(token));
+                prod.name += " " + std::string(token.text);
+                continue;
+            }
+
+            const auto terminal = terminalsByName().find(token.text);
+            if (terminal == terminalsByName().end()) {
+                fail(token.line, "unknown terminal '" + std::string(token.text) + "'");
+            }
+            prod.body.push_back(terminal->second);
+            prod.name += " " + std::string(terminalSpelling(terminal->second));
+        }
+    }
+
+    if (productions_.size() == 1) {
+        utils::THROW("Grammar file '" + grammar_filename + "' has no rules");
+    }
+
+    for (size_t nt_ind = 1; nt_ind < non_terminal_names_.size(); ++nt_ind) {
+        const Symbol sym = static_cast<Symbol>(static_cast<size_t>(Symbol::NT_START) + nt_ind);
+        if (!defined.contains(sym)) {
+            const GrammarToken& use = first_use[nt_ind - 1];
+            fail(use.line, "nonterminal " + std::string(use.text) + " has no rules");
+        }
+    }
+
+    const Production& first_rule = productions_[1];
+    const std::string first_rule_head = first_rule.name.substr(0, first_rule.name.find(" ->"));
+    productions_[0].body = {first_rule.head};
+    productions_[0].name = "<start> -> " + first_rule_head;
+
+    buildFirstSets();
+    buildFollowSets();
+}
+
+}
+}
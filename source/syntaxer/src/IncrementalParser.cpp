@@ -0,0 +1,327 @@
+#include "syntaxer/IncrementalParser.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "utils/common.hpp"
+
+namespace slr {
+namespace syntaxer {
+
+IncrementalParser::IncrementalParser(const Grammar& grammar, const ParsingTable& table, lexer::LexerKind lexer_kind)
+    :   table_(table)
+    ,   lexer_kind_(lexer_kind)
+{
+    for (const auto& prod : grammar.getProductions()) {
+        body_size_.push_back(static_cast<uint32_t>(prod.body.size()));
+        head_.push_back(prod.head);
+    }
+}
+
+const std::string&          IncrementalParser::getText      () const noexcept { return text_; }
+size_t                      IncrementalParser::getTokenCount() const noexcept { return front_tokens_.size() + back_tokens_.size(); }
+const IncrementalResult&    IncrementalParser::getResult    () const noexcept { return result_; }
+
+const IncrementalResult& IncrementalParser::reset(std::string text) {
+    text_ = std::move(text);
+
+    front_tokens_.clear();
+    back_tokens_.clear();
+
+    std::vector<TokenSpan> tokens;
+    relex(0, 1, 0, tokens);
+    front_tokens_ = std::move(tokens);
+    end_line_ = front_tokens_.back().line;
+
+    checkpoints_.clear();
+    checkpoints_.push_back({0, {0}, std::nullopt});
+
+    run(0, 1, 1);
+    result_.relexed_tokens = getTokenCount();
+    setResult();
+
+    return result_;
+}
+
+const IncrementalResult& IncrementalParser::edit(const TextEdit& edit) {
+    if (edit.begin > text_.size() || edit.length > text_.size() - edit.begin) {
+        utils::THROW(
+            "Edit at " + std::to_string(edit.begin) + " of length " + std::to_string(edit.length)
+            + " is out of the document (" + std::to_string(text_.size()) + " characters)"
+        );
+    }
+    const size_t edit_end = edit.begin + edit.length;
+
+    // Первый затронутый токен. Число смотрит на два символа вперёд ("1" + ".5"),
+    // поэтому затронут и токен, который кончается за символ до правки
+    const size_t first = findToken(0, [&](const TokenSpan& token) {
+        return token.begin + token.length + 1 < edit.begin;
+    });
+
+    // старые токены, которые целиком за правкой - кандидаты на совпадение после перелексирования
+    const size_t resync_from = findToken(first, [&](const TokenSpan& token) { return token.begin < edit_end; });
+
+    const size_t old_count = getTokenCount();
+    // где остановился текущий разбор: снимки дальше - от прежних разборов
+    const size_t stop = error_.has_value() ? error_->token_ind : old_count - 1;
+
+    const TokenSpan before = (first > 0) ? tokenAt(first - 1) : TokenSpan{lexer::TokenType::END_OF_FILE, 0, 0, 1};
+    const size_t lex_begin = before.begin + before.length;
+
+    // токены с first отсчитываются от конца текста и правку не замечают
+    moveGap(first);
+    text_.replace(edit.begin, edit.length, edit.replacement);
+
+    std::vector<TokenSpan> new_tokens;
+    const size_t resync = relex(lex_begin, before.line, resync_from, new_tokens);
+    result_.relexed_tokens = new_tokens.size();
+
+    // tokenAt(resync) и дальше остаются, сдвигается только строка конца
+    if (resync < old_count) {
+        end_line_ += new_tokens.back().line - tokenAt(resync).line;
+        new_tokens.pop_back();
+    }
+    else {
+        end_line_ = new_tokens.back().line;
+    }
+
+    const ptrdiff_t token_shift = static_cast<ptrdiff_t>(new_tokens.size()) - static_cast<ptrdiff_t>(resync - first);
+    const size_t changed_end = first + new_tokens.size();
+
+    back_tokens_.resize(back_tokens_.size() - (resync - first));
+    front_tokens_.insert(front_tokens_.end(), new_tokens.begin(), new_tokens.end());
+
+    auto shiftToken = [&](size_t token_ind) {
+        return static_cast<size_t>(static_cast<ptrdiff_t>(token_ind) + token_shift);
+    };
+
+    // Снимки до first (и не дальше остановки) не изменились. Снимки за старыми перелексированными
+    // токенами - для сравнения, остальные теперь проходят через правку
+    const auto keep_end = std::partition_point(
+        checkpoints_.begin(), checkpoints_.end(),
+        [&](const Checkpoint& checkpoint) { return checkpoint.token_ind <= std::min(first, stop); }
+    );
+    const auto tail_begin = std::partition_point(
+        keep_end, checkpoints_.end(),
+        [&](const Checkpoint& checkpoint) { return checkpoint.token_ind < resync; }
+    );
+
+    for (auto checkpoint = tail_begin; checkpoint != checkpoints_.end(); ++checkpoint) {
+        checkpoint->token_ind = shiftToken(checkpoint->token_ind);
+        if (checkpoint->outcome.has_value()) {
+            checkpoint->outcome->token_ind = shiftToken(checkpoint->outcome->token_ind);
+        }
+    }
+
+    // ошибка до правки от неё не зависит
+    if (stop < first) {
+        checkpoints_.erase(keep_end, tail_begin);
+        result_.reparsed_tokens = 0;
+        setResult();
+        return result_;
+    }
+
+    run(
+        changed_end, 
+        static_cast<size_t>(keep_end - checkpoints_.begin()), 
+        static_cast<size_t>(tail_begin - checkpoints_.begin())
+    );
+    setResult();
+
+    return result_;
+}
+
+size_t IncrementalParser::relex(size_t begin, int line, size_t resync_from, std::vector<TokenSpan>& out) const {
+    // номера строк - сразу от начала текста, в том числе в сообщении о лексической ошибке
+    const auto lexer = lexer::makeLexer(lexer_kind_, std::string_view(text_).substr(begin), nullptr, line);
+    const size_t old_count = getTokenCount();
+
+    size_t old_ind = resync_from;
+
+    while (true) {
+        const lexer::Token& token = lexer->next();
+        const bool end = (token.type == lexer::TokenType::END_OF_FILE);
+
+        const TokenSpan span{
+            token.type,
+            end ? text_.size() : static_cast<size_t>(token.value.data() - text_.data()),
+            end ? 0 : token.value.size(),
+            token.line
+        };
+        out.push_back(span);
+
+        while (old_ind < old_count && tokenAt(old_ind).begin < span.begin) {
+            ++old_ind;
+        }
+        if (old_ind < old_count) {
+            const TokenSpan old = tokenAt(old_ind);
+            if (old.begin == span.begin && old.type == span.type && old.length == span.length) {
+                return old_ind;
+            }
+        }
+
+        if (end) {
+            return old_count;
+        }
+    }
+}
+
+void IncrementalParser::run(size_t converge_from, size_t keep, size_t tail) {
+    stack_ = checkpoints_[keep - 1].stack;
+    const size_t start_ind = checkpoints_[keep - 1].token_ind;
+    size_t token_ind = start_ind;
+    size_t last_checkpoint = start_ind;
+
+    // снимки этого прогона, встают на место [keep, tail_end)
+    std::vector<Checkpoint> fresh;
+    std::optional<size_t> tail_end;
+
+    error_.reset();
+
+    // Граница токенов: совпал ли стек со старым снимком (тогда остальное берётся из прошлого разбора)
+    auto boundary = [&]() {
+        while (tail < checkpoints_.size() && checkpoints_[tail].token_ind < token_ind) {
+            ++tail;
+        }
+        if (token_ind >= converge_from && tail < checkpoints_.size()
+            && checkpoints_[tail].token_ind == token_ind && checkpoints_[tail].stack == stack_) {
+            tail_end = tail;
+            error_ = checkpoints_[tail].outcome;
+            return true;
+        }
+
+        if (token_ind - last_checkpoint >= CHECKPOINT_INTERVAL) {
+            fresh.push_back({token_ind, stack_, std::nullopt});
+            last_checkpoint = token_ind;
+        }
+        return false;
+    };
+
+    auto finish = [&] {
+        result_.reparsed_tokens = token_ind - start_ind;
+
+        // не сошлись: старые снимки за местом остановки остаются от прежних разборов
+        if (!tail_end.has_value()) {
+            while (tail < checkpoints_.size() && checkpoints_[tail].token_ind <= token_ind) {
+                ++tail;
+            }
+            tail_end = tail;
+        }
+
+        const auto begin = checkpoints_.begin() + static_cast<ptrdiff_t>(keep);
+        checkpoints_.erase(begin, checkpoints_.begin() + static_cast<ptrdiff_t>(*tail_end));
+        checkpoints_.insert(
+            checkpoints_.begin() + static_cast<ptrdiff_t>(keep),
+            std::make_move_iterator(fresh.begin()), 
+            std::make_move_iterator(fresh.end())
+        );
+
+        const size_t current_end = keep + fresh.size();
+        for (size_t checkpoint_ind = 0; checkpoint_ind < current_end; ++checkpoint_ind) {
+            checkpoints_[checkpoint_ind].outcome = error_;
+        }
+    };
+
+    if (boundary()) {
+        finish();
+        return;
+    }
+
+    while (true) {
+        const StateNum current_state = stack_.back();
+        const ActionCell cell = table_.getActionCell(current_state, Grammar::fromTokenType(tokenAt(token_ind).type));
+
+        switch (ParseAction::cellType(cell)) {
+            case ActionType::SHIFT: {
+                stack_.push_back(ParseAction::cellTarget(cell));
+                ++token_ind;
+                if (boundary()) {
+                    finish();
+                    return;
+                }
+                break;
+            }
+
+            case ActionType::REDUCE: {
+                const size_t prod_ind = ParseAction::cellTarget(cell);
+                if (body_size_[prod_ind] >= stack_.size()) {
+                    error_ = ErrorPoint{token_ind, current_state};
+                    finish();
+                    return;
+                }
+                stack_.resize(stack_.size() - body_size_[prod_ind]);
+
+                const auto goto_state = table_.getGoto(stack_.back(), head_[prod_ind]);
+                if (!goto_state) {
+                    error_ = ErrorPoint{token_ind, current_state};
+                    finish();
+                    return;
+                }
+                stack_.push_back(*goto_state);
+                break;
+            }
+
+            case ActionType::ACCEPT: {
+                finish();
+                return;
+            }
+
+            case ActionType::ERROR:
+            default: {
+                error_ = ErrorPoint{token_ind, current_state};
+                finish();
+                return;
+            }
+        }
+    }
+}
+
+void IncrementalParser::setResult() {
+    result_.error_message.reset();
+    result_.error_location.reset();
+
+    if (!error_.has_value()) {
+        return;
+    }
+
+    const lexer::Token token = makeToken(error_->token_ind);
+    result_.error_message =
+        "Syntax error in line " + std::to_string(token.line) + ", token is "
+        + std::string(token.value) + "(state " + std::to_string(error_->state) + ")";
+    result_.error_location = ParseErrorLocation{error_->token_ind, token.line};
+}
+
+IncrementalParser::TokenSpan IncrementalParser::tokenAt(size_t token_ind) const noexcept {
+    if (token_ind < front_tokens_.size()) {
+        return front_tokens_[token_ind];
+    }
+    return fromEnd(back_tokens_[getTokenCount() - 1 - token_ind]);
+}
+
+IncrementalParser::TokenSpan IncrementalParser::fromEnd(const TokenSpan& span) const noexcept {
+    // преобразование симметрично: от конца к началу так же, как от начала к концу
+    return {span.type, text_.size() - span.begin, span.length, end_line_ - span.line};
+}
+
+void IncrementalParser::moveGap(size_t token_ind) {
+    while (front_tokens_.size() > token_ind) {
+        back_tokens_.push_back(fromEnd(front_tokens_.back()));
+        front_tokens_.pop_back();
+    }
+    while (front_tokens_.size() < token_ind) {
+        front_tokens_.push_back(fromEnd(back_tokens_.back()));
+        back_tokens_.pop_back();
+    }
+}
+
+lexer::Token IncrementalParser::makeToken(size_t token_ind) const noexcept {
+    const TokenSpan span = tokenAt(token_ind);
+    if (span.type == lexer::TokenType::END_OF_FILE) {
+        return {span.type, "$", span.line};
+    }
+    return {span.type, std::string_view(text_).substr(span.begin, span.length), span.line};
+}
+
+}
+}
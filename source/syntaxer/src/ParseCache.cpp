@@ -0,0 +1,126 @@
+#include "syntaxer/ParseCache.hpp"
+
+#include <cassert>
+#include <iterator>
+
+namespace slr {
+namespace syntaxer {
+
+ParseCache::ParseCache(size_t capacity, CacheEviction eviction)
+    :   capacity_(capacity)
+    ,   eviction_(eviction)
+{
+    assert(capacity_ != 0);
+    index_.reserve(capacity_);
+}
+
+std::optional<CacheEviction> ParseCache::evictionFromStr(std::string_view str) noexcept {
+    if (str == "lru") {
+        return CacheEviction::LRU;
+    }
+    if (str == "fifo") {
+        return CacheEviction::FIFO;
+    }
+    return std::nullopt;
+}
+
+uint64_t ParseCache::hashTokens(std::span<const lexer::Token> tokens) noexcept {
+    // FNV-1a по типу и байтам значения; длина значения разделяет соседние токены
+    constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+    constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+    uint64_t hash = FNV_OFFSET;
+    auto mix = [&hash](uint64_t byte) {
+        hash = (hash ^ byte) * FNV_PRIME;
+    };
+
+    for (const auto& token : tokens) {
+        mix(static_cast<uint64_t>(token.type));
+        for (char c : token.value) {
+            mix(static_cast<unsigned char>(c));
+        }
+        mix(token.value.size());
+    }
+
+    return hash;
+}
+
+bool ParseCache::Entry::matches(std::span<const lexer::Token> tokens) const noexcept {
+    if (tokens.size() != types.size()) {
+        return false;
+    }
+
+    uint32_t value_begin = 0;
+    for (size_t token_ind = 0; token_ind < tokens.size(); ++token_ind) {
+        const auto& token = tokens[token_ind];
+        const std::string_view value(text.data() + value_begin, value_ends[token_ind] - value_begin);
+
+        if (token.type != types[token_ind] || token.line != lines[token_ind] || token.value != value) {
+            return false;
+        }
+        value_begin = value_ends[token_ind];
+    }
+
+    return true;
+}
+
+std::optional<ParseCache::EntryIter> ParseCache::find(uint64_t hash, std::span<const lexer::Token> tokens) {
+    const auto [begin, end] = index_.equal_range(hash);
+
+    for (auto found = begin; found != end; ++found) {
+        const EntryIter entry = found->second;
+        if (!entry->matches(tokens)) {
+            continue;
+        }
+
+        if (eviction_ == CacheEviction::LRU) {
+            entries_.splice(entries_.begin(), entries_, entry);
+        }
+        return entry;
+    }
+
+    return std::nullopt;
+}
+
+const ParseResult& ParseCache::insert(uint64_t hash, std::span<const lexer::Token> tokens, ParseResult result) {
+    if (entries_.size() == capacity_) {
+        const EntryIter oldest = std::prev(entries_.end());
+        const auto [begin, end] = index_.equal_range(oldest->hash);
+        for (auto found = begin; found != end; ++found) {
+            if (found->second == oldest) {
+                index_.erase(found);
+                break;
+            }
+        }
+        entries_.erase(oldest);
+    }
+
+    Entry entry{hash, {}, {}, {}, {}, std::move(result)};
+    entry.types.reserve(tokens.size());
+    entry.lines.reserve(tokens.size());
+    entry.value_ends.reserve(tokens.size());
+
+    for (const auto& token : tokens) {
+        entry.types.push_back(token.type);
+        entry.lines.push_back(token.line);
+        entry.text.append(token.value);
+        entry.value_ends.push_back(static_cast<uint32_t>(entry.text.size()));
+    }
+
+    entries_.push_front(std::move(entry));
+    index_.emplace(hash, entries_.begin());
+
+    return entries_.front().result;
+}
+
+CacheStats  ParseCache::getStats    () const noexcept { return stats_; }
+size_t      ParseCache::size        () const noexcept { return entries_.size(); }
+size_t      ParseCache::getCapacity () const noexcept { return capacity_; }
+
+void ParseCache::clear() noexcept {
+    entries_.clear();
+    index_.clear();
+}
+
+}
+}
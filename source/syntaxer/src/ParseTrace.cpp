@@ -0,0 +1,41 @@
+#include "syntaxer/ParseTrace.hpp"
+
+namespace slr {
+namespace syntaxer {
+
+ParseTrace::ParseTrace(size_t limit) 
+    :   limit_(limit)
+    ,   base_stack_{Symbol::END_OF_FILE}
+{
+    if (limit_ != UNLIMITED) {
+        steps_.reserve(limit_);
+    }
+}
+
+std::optional<ParseStep> ParseTrace::push(const ParseStep& step) {
+    if (limit_ == UNLIMITED || steps_.size() < limit_) {
+        steps_.push_back(step);
+        return std::nullopt;
+    }
+
+    ParseStep evicted = steps_[head_];
+    steps_[head_] = step;
+    head_ = (head_ + 1) % limit_;
+    ++dropped_;
+
+    return evicted;
+}
+
+const ParseStep& ParseTrace::operator[](size_t ind) const noexcept {
+    return steps_[(head_ + ind) % steps_.size()];
+}
+
+size_t                      ParseTrace::size            () const noexcept { return steps_.size(); }
+bool                        ParseTrace::empty           () const noexcept { return steps_.empty(); }
+size_t                      ParseTrace::getLimit        () const noexcept { return limit_; }
+size_t                      ParseTrace::getDroppedCount () const noexcept { return dropped_; }
+const std::vector<Symbol>&  ParseTrace::getBaseStack    () const noexcept { return base_stack_; }
+std::vector<Symbol>&        ParseTrace::getBaseStack    ()       noexcept { return base_stack_; }
+
+}
+}
\ No newline at end of file
@@ -2,257 +2,921 @@
 
 #include <iomanip>
 #include <iostream>
-#include <queue>
+#include <unordered_map>
 #include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <bit>
 #include <cassert>
-
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <utility>
+
+#include "syntaxer/StaticTable.hpp"
+#include "syntaxer/TableCompression.hpp"
+#include "utils/common.hpp"
 // #include "utils/concole.hpp"
 
 namespace slr {
 namespace syntaxer {
 
-ParseAction ParseAction::shift(size_t state) noexcept {
-    return {ActionType::SHIFT, state, ""};
+bool ParsingTable::isCompleteItem(ItemId item) const noexcept {
+    return item_symbol_[item] == Symbol::UNKNOWN;
 }
-ParseAction ParseAction::reduce(size_t prod_ind, std::string rule_name) noexcept {
-    return {ActionType::REDUCE, prod_ind, std::move(rule_name)};
+
+Symbol ParsingTable::symbolAtDot(ItemId item) const noexcept {
+    return item_symbol_[item];
 }
-ParseAction ParseAction::accept() noexcept {
-    return {ActionType::ACCEPT, TARGET_POISION, ""};
+
+namespace {
+
+size_t hashKernel(const ItemSet& kernel) noexcept {
+    size_t hash = kernel.size();
+    for (ItemId item : kernel) {
+        hash ^= std::hash<size_t>{}(item) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    }
+    return hash;
 }
-ParseAction ParseAction::error() noexcept {
-    return {ActionType::ERROR, TARGET_POISION, ""};
+
+// DeRemer-Pennello digraph: F(x) |= F(y) для всех y, достижимых из x по relation.
+// Компоненты сильной связности получают общее множество.
+// Множества задаются операциями: unite(x, y) - F(x) |= F(y), assign(x, y) - F(x) = F(y)
+template <typename Unite, typename Assign>
+void digraphVisit(
+    size_t x, 
+    const std::vector<std::vector<size_t>>& relation,
+    std::vector<size_t>& depth,
+    std::vector<size_t>& stack,
+    Unite& unite,
+    Assign& assign
+) {
+    constexpr size_t DONE = std::numeric_limits<size_t>::max();
+
+    stack.push_back(x);
+    const size_t x_depth = stack.size();
+    depth[x] = x_depth;
+
+    for (size_t y : relation[x]) {
+        if (depth[y] == 0) {
+            digraphVisit(y, relation, depth, stack, unite, assign);
+        }
+        depth[x] = std::min(depth[x], depth[y]);
+        unite(x, y);
+    }
+
+    if (depth[x] == x_depth) {
+        while (true) {
+            const size_t top = stack.back();
+            stack.pop_back();
+            depth[top] = DONE;
+            if (top == x) {
+                break;
+            }
+            assign(top, x);
+        }
+    }
 }
 
-Item::Item(size_t prod_ind, size_t dot) noexcept 
-    :   prod_ind(prod_ind)
-    ,   dot_pos(dot) 
-{}
+template <typename Unite, typename Assign>
+void digraph(const std::vector<std::vector<size_t>>& relation, Unite&& unite, Assign&& assign) {
+    std::vector<size_t> depth(relation.size(), 0);
+    std::vector<size_t> stack;
 
-bool ParsingTable::isCompleteItem(const Item& item) const {
-    const auto& prod = grammar_.getProductions()[item.prod_ind];
-    return item.dot_pos == prod.body.size();
+    for (size_t x = 0; x < relation.size(); ++x) {
+        if (depth[x] == 0) {
+            digraphVisit(x, relation, depth, stack, unite, assign);
+        }
+    }
 }
 
-Symbol ParsingTable::symbolAtDot(const Item& item) const {
-    const auto& prod = grammar_.getProductions()[item.prod_ind];
-    if (item.dot_pos >= prod.body.size()) {
-        return Symbol::UNKNOWN;
+void digraph(std::vector<TerminalMask>& sets, const std::vector<std::vector<size_t>>& relation) {
+    digraph(
+        relation,
+        [&](size_t x, size_t y) { sets[x] |= sets[y]; },
+        [&](size_t x, size_t y) { sets[x] = sets[y]; }
+    );
+}
+
+// Вызывает f(bit) для каждого установленного бита маски по возрастанию
+template <typename F>
+void forEachBit(const std::vector<uint64_t>& mask, F&& f) {
+    for (size_t word_ind = 0; word_ind < mask.size(); ++word_ind) {
+        for (uint64_t word = mask[word_ind]; word != 0; word &= word - 1) {
+            f(word_ind * 64 + static_cast<size_t>(std::countr_zero(word)));
+        }
     }
-    return prod.body[item.dot_pos];
 }
 
-ItemSet ParsingTable::closure(const ItemSet& items) {
-    ItemSet result = items;
-    std::vector<Item> stack(items.begin(), items.end());
-    
-    while (!stack.empty()) {
-        Item current = stack.back();
-        stack.pop_back();
-        
-        // if (current.dot_pos < grammar_.getProductions()[current.prod_index].body.size())
-        // std::cerr << RED_FORMAT << current.dot_pos << " " << grammar_.getProductions()[current.prod_index].name << " " << grammar_.getProductions()[current.prod_index].body.size() << NORMAL_FORMAT << std::endl;
-        Symbol next_sym = symbolAtDot(current);
+constexpr StateNum STATE_NONE = std::numeric_limits<StateNum>::max();
+
+// Пул потоков для обхода уровня BFS: run(count, f) вызывает f(index, worker_ind) для всех index < count,
+// индексы раздаются порциями через общий счётчик. Потоки запускаются на первом большом уровне, живут
+// до конца построения и ждут уровня на барьере. Маленькие уровни вызывающий поток обходит сам
+class LevelWorkers {
+
+public:
+
+    explicit LevelWorkers(size_t jobs)
+        :   jobs_(std::max<size_t>(jobs, 1))
+        ,   start_(static_cast<std::ptrdiff_t>(jobs_))
+        ,   finish_(static_cast<std::ptrdiff_t>(jobs_))
+    {}
 
-        if (Grammar::isNonTerminal(next_sym)) {
-            for (size_t prod_ind = 0; prod_ind < grammar_.getProductionCount(); ++prod_ind) {
-                const auto& prod = grammar_.getProductions()[prod_ind];
+    LevelWorkers(const LevelWorkers& that) = delete;
+    LevelWorkers& operator=(const LevelWorkers& that) = delete;
 
-                if (prod.head == next_sym) {
-                    Item new_item(prod_ind, 0);
+    ~LevelWorkers() {
+        stop_ = true;
+        if (!threads_.empty()) {
+            start_.arrive_and_wait();
+        }
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    size_t size() const noexcept { return jobs_; }
+
+    void run(size_t count, const std::function<void(size_t, size_t)>& task) {
+        if (jobs_ == 1 || count < PARALLEL_MIN_COUNT) {
+            for (size_t index = 0; index < count; ++index) {
+                task(index, 0);
+            }
+            return;
+        }
 
-                    if (result.insert(new_item).second) {
-                        stack.push_back(new_item);
+        if (threads_.empty()) {
+            startThreads();
+        }
+
+        task_ = &task;
+        count_ = count;
+        next_.store(0, std::memory_order_relaxed);
+
+        start_.arrive_and_wait();
+        work(0);
+        finish_.arrive_and_wait();
+
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+private:
+
+    constexpr inline static size_t PARALLEL_MIN_COUNT = 64;
+    constexpr inline static size_t CHUNK = 16;
+
+    void startThreads() {
+        threads_.reserve(jobs_ - 1);
+        for (size_t worker_ind = 1; worker_ind < jobs_; ++worker_ind) {
+            threads_.emplace_back([this, worker_ind] {
+                while (true) {
+                    start_.arrive_and_wait();
+                    if (stop_) {
+                        return;
                     }
+                    work(worker_ind);
+                    finish_.arrive_and_wait();
+                }
+            });
+        }
+    }
+
+    void work(size_t worker_ind) {
+        while (true) {
+            const size_t begin = next_.fetch_add(CHUNK, std::memory_order_relaxed);
+            if (begin >= count_) {
+                return;
+            }
+            try {
+                for (size_t index = begin; index < std::min(begin + CHUNK, count_); ++index) {
+                    (*task_)(index, worker_ind);
+                }
+            }
+            catch (...) {
+                std::lock_guard lock(error_mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
                 }
             }
         }
     }
-    
-    return result;
+
+    size_t jobs_;
+    std::barrier<> start_;
+    std::barrier<> finish_;
+    std::vector<std::thread> threads_;
+
+    // пишутся вызывающим потоком до start_, читаются воркерами после него
+    const std::function<void(size_t, size_t)>* task_ = nullptr;
+    size_t count_ = 0;
+    bool stop_ = false;
+    std::atomic<size_t> next_ = 0;
+
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
 }
 
-ItemSet ParsingTable::gotoState(const ItemSet& items, Symbol symbol) {
-    ItemSet result;
-    
-    for (const auto& item : items) {
-        if (symbolAtDot(item) == symbol) {
-            Item moved(item.prod_ind, item.dot_pos + 1);
-            result.insert(std::move(moved));
+void ParsingTable::buildItemIndex() {
+    const auto& prods = grammar_.getProductions();
+    const size_t nt_count = symbol_count_ - static_cast<size_t>(Symbol::NT_START);
+
+    prods_by_head_.assign(symbol_count_, {});
+    item_offset_.clear();
+    item_prod_.clear();
+    item_symbol_.clear();
+    has_epsilon_ = false;
+
+    for (size_t prod_ind = 0; prod_ind < prods.size(); ++prod_ind) {
+        const auto& body = prods[prod_ind].body;
+        prods_by_head_[static_cast<size_t>(prods[prod_ind].head)].push_back(prod_ind);
+
+        item_offset_.push_back(static_cast<ItemId>(item_prod_.size()));
+        for (size_t dot = 0; dot <= body.size(); ++dot) {
+            item_prod_.push_back(static_cast<uint32_t>(prod_ind));
+            item_symbol_.push_back(dot < body.size() ? body[dot] : Symbol::UNKNOWN);
+        }
+        has_epsilon_ |= body.empty();
+    }
+
+    // Строка A - сам A и всё, что достижимо по рёбрам A -> нетерминал в начале тела продукции A
+    std::vector<std::vector<size_t>> starts_with(nt_count);
+    for (size_t prod_ind = 0; prod_ind < prods.size(); ++prod_ind) {
+        const Symbol first = item_symbol_[item_offset_[prod_ind]];
+        if (Grammar::isNonTerminal(first)) {
+            starts_with[static_cast<size_t>(prods[prod_ind].head) - static_cast<size_t>(Symbol::NT_START)]
+                .push_back(static_cast<size_t>(first) - static_cast<size_t>(Symbol::NT_START));
+        }
+    }
+
+    nt_words_ = (nt_count + 63) / 64;
+    nt_closure_.assign(nt_count * nt_words_, 0);
+    for (size_t nt = 0; nt < nt_count; ++nt) {
+        nt_closure_[nt * nt_words_ + nt / 64] |= uint64_t{1} << (nt % 64);
+    }
+
+    auto row = [&](size_t nt) { return nt_closure_.data() + nt * nt_words_; };
+    digraph(
+        starts_with,
+        [&](size_t x, size_t y) { 
+            for (size_t word = 0; word < nt_words_; ++word) {
+                row(x)[word] |= row(y)[word];
+            }
+        },
+        [&](size_t x, size_t y) { std::copy(row(y), row(y) + nt_words_, row(x)); }
+    );
+}
+
+void ParsingTable::closureMask(const ItemSet& kernel, std::vector<uint64_t>& mask) const {
+    mask.assign(nt_words_, 0);
+
+    for (ItemId item : kernel) {
+        const Symbol sym = item_symbol_[item];
+        if (!Grammar::isNonTerminal(sym)) {
+            continue;
+        }
+        const uint64_t* row = nt_closure_.data() 
+            + (static_cast<size_t>(sym) - static_cast<size_t>(Symbol::NT_START)) * nt_words_;
+        for (size_t word = 0; word < nt_words_; ++word) {
+            mask[word] |= row[word];
         }
     }
-    return closure(result);
 }
 
 void ParsingTable::buildCanonicalCollection() {
+    const size_t sym_count = symbol_count_;
+
     states_.clear();
-    std::queue<ItemSet> bfs_queue;
+    transitions_.clear();
+
+    buildItemIndex();
+
+    // Состояние однозначно задаётся ядром; ядра лежат в states_, индекс - хеш ядра -> номер состояния.
+    // Внутри уровня BFS индекс только читается (параллельно), пополняется между уровнями
+    std::unordered_multimap<size_t, StateNum> state_by_hash;
+
+    auto find = [&](const ItemSet& kernel, size_t hash) -> StateNum {
+        const auto [begin, end] = state_by_hash.equal_range(hash);
+        for (auto found = begin; found != end; ++found) {
+            if (states_[found->second] == kernel) {
+                return found->second;
+            }
+        }
+        return STATE_NONE;
+    };
+
+    auto add = [&](ItemSet&& kernel, size_t hash) -> StateNum {
+        const StateNum state = states_.size();
+        states_.push_back(std::move(kernel));
+        transitions_.emplace_back();
+        state_by_hash.emplace(hash, state);
+        return state;
+    };
     
-    ItemSet initial;
-    for (size_t i = 0; i < grammar_.getProductionCount(); ++i) {
-        const auto& prod = grammar_.getProductions()[i];
-        if (prod.head == Symbol::NT_START) {
-            initial.insert(Item(i, 0));
-            break;
+    ItemSet initial = {item_offset_[prods_by_head_[static_cast<size_t>(Symbol::NT_START)].front()]};
+    const size_t initial_hash = hashKernel(initial);
+    add(std::move(initial), initial_hash);
+
+    // Переход состояния уровня; state == STATE_NONE - ядра не было в индексе на начало уровня
+    struct Successor {
+        Symbol symbol;
+        size_t hash;
+        StateNum state;
+        ItemSet kernel;
+    };
+
+    // Рабочие буферы потока
+    struct Scratch {
+        std::vector<ItemSet> next_kernels;
+        std::vector<size_t> next_symbols;
+        std::vector<uint64_t> mask;
+    };
+
+    // Переходы state по возрастанию символа, чтобы нумерация состояний не зависела от порядка итемов
+    auto successors = [&](StateNum state, Scratch& scratch, std::vector<Successor>& out) {
+        auto addNext = [&](ItemId next_item, Symbol sym) {
+            const size_t sym_ind = static_cast<size_t>(sym);
+            if (scratch.next_kernels[sym_ind].empty()) {
+                scratch.next_symbols.push_back(sym_ind);
+            }
+            scratch.next_kernels[sym_ind].push_back(next_item);
+        };
+
+        // массив на символ заводится только у воркеров, которым достались состояния
+        if (scratch.next_kernels.empty()) {
+            scratch.next_kernels.resize(sym_count);
+        }
+        scratch.next_symbols.clear();
+
+        for (ItemId item : states_[state]) {
+            if (!isCompleteItem(item)) {
+                addNext(item + 1, symbolAtDot(item));
+            }
+        }
+
+        // итемы замыкания: у продукций нетерминалов маски точка в начале
+        closureMask(states_[state], scratch.mask);
+        forEachBit(scratch.mask, [&](size_t nt) {
+            for (size_t prod_ind : prods_by_head_[static_cast<size_t>(Symbol::NT_START) + nt]) {
+                const ItemId item = item_offset_[prod_ind];
+                if (!isCompleteItem(item)) {
+                    addNext(item + 1, symbolAtDot(item));
+                }
+            }
+        });
+
+        std::sort(scratch.next_symbols.begin(), scratch.next_symbols.end());
+
+        out.clear();
+        for (size_t sym_ind : scratch.next_symbols) {
+            ItemSet& kernel = scratch.next_kernels[sym_ind];
+            std::sort(kernel.begin(), kernel.end());
+            const size_t hash = hashKernel(kernel);
+            const StateNum found = find(kernel, hash);
+            out.push_back({
+                static_cast<Symbol>(sym_ind), 
+                hash, 
+                found, 
+                found == STATE_NONE ? std::move(kernel) : ItemSet{}
+            });
+            kernel.clear();
+        }
+    };
+
+    LevelWorkers workers(build_jobs_);
+    std::vector<Scratch> scratches(workers.size());
+    std::vector<std::vector<Successor>> level_successors;
+
+    // BFS по уровням: переходы всех состояний уровня считаются параллельно, а новые состояния
+    // нумеруются последовательно в порядке (состояние, символ) - так же, как в обычном BFS
+    for (StateNum level_begin = 0; level_begin < states_.size();) {
+        const StateNum level_end = states_.size();
+        level_successors.resize(level_end - level_begin);
+
+        workers.run(level_end - level_begin, [&](size_t offset, size_t worker_ind) {
+            successors(level_begin + offset, scratches[worker_ind], level_successors[offset]);
+        });
+
+        for (StateNum state = level_begin; state < level_end; ++state) {
+            for (Successor& next : level_successors[state - level_begin]) {
+                StateNum target = next.state;
+                if (target == STATE_NONE) {
+                    // ядро могло появиться раньше на этом же уровне
+                    target = find(next.kernel, next.hash);
+                    if (target == STATE_NONE) {
+                        target = add(std::move(next.kernel), next.hash);
+                    }
+                }
+                transitions_[state].push_back({next.symbol, target});
+            }
         }
+
+        level_begin = level_end;
     }
-    initial = closure(initial);
-    
-    states_.push_back(initial);
-    bfs_queue.push(initial);
-    
-    while (!bfs_queue.empty()) {
-        ItemSet current = bfs_queue.front();
-        bfs_queue.pop();
-        
-        for (int i = 1; i < static_cast<int>(Symbol::COUNT); ++i) {
-            Symbol sym = static_cast<Symbol>(i);
+}
 
-            ItemSet next = gotoState(current, sym);
+void ParsingTable::setAction(ActionCell* action_row, StateNum state, Symbol terminal, ParseAction action) {
+    ActionCell& cell = action_row[static_cast<size_t>(terminal)];
+    const ParseAction current{ParseAction::cellType(cell), ParseAction::cellTarget(cell)};
 
-            // std::cerr << "AFTER GOTO STATE\n";
-            
-            if (!next.empty() && std::find(states_.begin(), states_.end(), next) == states_.end()) {
-                states_.push_back(next);
-                bfs_queue.push(next);
+    if (current.type == ActionType::ERROR) {
+        cell = action.pack();
+        return;
+    }
+
+    // accept - это reduce по пополняющей продукции 0
+    auto reduceInd = [](const ParseAction& act) { 
+        return (act.type == ActionType::ACCEPT) ? 0 : act.target; 
+    };
+
+    const bool shift_reduce = (current.type == ActionType::SHIFT || action.type == ActionType::SHIFT);
+    const bool keep_current = (current.type == ActionType::SHIFT) 
+        || (action.type != ActionType::SHIFT && reduceInd(current) <= reduceInd(action));
+
+    conflicts_.push_back({
+        shift_reduce ? ConflictType::SHIFT_REDUCE : ConflictType::REDUCE_REDUCE,
+        state,
+        terminal,
+        keep_current ? current : action,
+        keep_current ? action : current
+    });
+
+    if (!keep_current) {
+        cell = action.pack();
+    }
+}
+
+namespace {
+
+TerminalMask terminalBit(Symbol terminal) {
+    return TerminalMask{1} << static_cast<size_t>(terminal);
+}
+
+std::string cellToString(const ParseAction& action) {
+    switch (action.type) {
+        case ActionType::SHIFT:
+            return "s" + std::to_string(action.target); 
+        case ActionType::REDUCE:
+            return "r" + std::to_string(action.target); 
+        case ActionType::ACCEPT:
+            return "acc"; 
+        case ActionType::ERROR:
+            return "err"; 
+    }
+    return "err";
+}
+
+}
+
+std::vector<std::unordered_map<size_t, TerminalMask>> ParsingTable::buildLalrLookaheads() const {
+    const size_t state_count = states_.size();
+    const size_t prod_count = grammar_.getProductionCount();
+    const auto& prods = grammar_.getProductions();
+
+    auto key = [&](StateNum state, Symbol sym) { 
+        return state * symbol_count_ + static_cast<size_t>(sym); 
+    };
+
+    // Нетерминальные переходы (p, A) нумеруются, по ним считаются множества
+    std::unordered_map<uint64_t, StateNum> goto_by_key;
+    std::unordered_map<uint64_t, size_t> nt_transition_by_key;
+    std::vector<std::pair<StateNum, Symbol>> nt_transitions;
+
+    for (StateNum state_ind = 0; state_ind < state_count; ++state_ind) {
+        for (const auto& transition : transitions_[state_ind]) {
+            goto_by_key.emplace(key(state_ind, transition.symbol), transition.target);
+
+            if (Grammar::isNonTerminal(transition.symbol)) {
+                nt_transition_by_key.emplace(key(state_ind, transition.symbol), nt_transitions.size());
+                nt_transitions.emplace_back(state_ind, transition.symbol);
             }
         }
     }
+
+    // DR(p, A): терминалы, по которым есть переход из goto(p, A), и $ после пополняющего старта.
+    // (p, A) reads (r, C), если r = goto(p, A) и C обнуляемый: Read = DR по замыканию reads
+    std::vector<TerminalMask> follow(nt_transitions.size(), 0);
+    std::vector<std::vector<size_t>> reads(nt_transitions.size());
+
+    for (size_t nt_ind = 0; nt_ind < nt_transitions.size(); ++nt_ind) {
+        const auto [state, sym] = nt_transitions[nt_ind];
+        const StateNum target = goto_by_key.at(key(state, sym));
+
+        for (const auto& transition : transitions_[target]) {
+            if (Grammar::isTerminal(transition.symbol)) {
+                follow[nt_ind] |= terminalBit(transition.symbol);
+            }
+            else if (grammar_.isNullable(transition.symbol)) {
+                reads[nt_ind].push_back(nt_transition_by_key.at(key(target, transition.symbol)));
+            }
+        }
+        for (ItemId item : states_[target]) {
+            if (prods[item_prod_[item]].head == Symbol::NT_START && isCompleteItem(item)) {
+                follow[nt_ind] |= terminalBit(Symbol::END_OF_FILE);
+            }
+        }
+    }
+
+    digraph(follow, reads);
+
+    // (q, C) includes (p, B), если B -> beta C gamma, gamma обнуляемо и из p по beta попадаем в q.
+    // lookback связывает законченный итем B -> beta. в конечном состоянии с (p, B)
+    std::vector<std::vector<size_t>> includes(nt_transitions.size());
+    std::unordered_map<uint64_t, std::vector<size_t>> lookback;
+
+    for (size_t nt_ind = 0; nt_ind < nt_transitions.size(); ++nt_ind) {
+        const auto [state, head] = nt_transitions[nt_ind];
+
+        for (size_t prod_ind : prods_by_head_[static_cast<size_t>(head)]) {
+            const auto& body = prods[prod_ind].body;
+            StateNum current = state;
+
+            // с какого места хвост тела обнуляем
+            size_t nullable_from = body.size();
+            while (nullable_from > 0 && grammar_.isNullable(body[nullable_from - 1])) {
+                --nullable_from;
+            }
+
+            for (size_t sym_ind = 0; sym_ind < body.size(); ++sym_ind) {
+                if (Grammar::isNonTerminal(body[sym_ind]) && sym_ind + 1 >= nullable_from) {
+                    includes[nt_transition_by_key.at(key(current, body[sym_ind]))].push_back(nt_ind);
+                }
+                current = goto_by_key.at(key(current, body[sym_ind]));
+            }
+
+            lookback[current * prod_count + prod_ind].push_back(nt_ind);
+        }
+    }
+
+    digraph(follow, includes);
+
+    std::vector<std::unordered_map<size_t, TerminalMask>> lookaheads(state_count);
+
+    for (const auto& [state_prod, nt_inds] : lookback) {
+        TerminalMask& mask = lookaheads[state_prod / prod_count][state_prod % prod_count];
+        for (size_t nt_ind : nt_inds) {
+            mask |= follow[nt_ind];
+        }
+    }
+
+    return lookaheads;
 }
 
 void ParsingTable::buildTables() {
-    size_t state_count = states_.size();
-    action_table_.resize(state_count);
-    goto_table_.resize(state_count);
+    const size_t state_count = states_.size();
+
+    assert(state_count < ParseAction::CELL_TARGET_MASK);
+    assert(grammar_.getProductionCount() < ParseAction::CELL_TARGET_MASK);
+
+    // Плотная ACTION нужна только до сжатия: в ней разрешаются конфликты
+    std::vector<ActionCell> action(state_count * TERMINAL_COUNT, ParseAction::error().pack());
+    std::vector<GotoRow> goto_rows(state_count);
+    conflicts_.clear();
+
+    std::vector<std::unordered_map<size_t, TerminalMask>> lalr_lookaheads;
+    if (mode_ == LookaheadMode::LALR) {
+        lalr_lookaheads = buildLalrLookaheads();
+    }
+
+    std::vector<ItemId> complete;
+    std::vector<uint64_t> mask;
     
     for (size_t state_ind = 0; state_ind < state_count; ++state_ind) {
-        const ItemSet& items = states_[state_ind];
+        ActionCell* action_row = action.data() + state_ind * TERMINAL_COUNT;
+
+        for (const auto& transition : transitions_[state_ind]) {
+            if (Grammar::isTerminal(transition.symbol)) { // SHIFT
+                setAction(action_row, state_ind, transition.symbol, ParseAction::shift(transition.target));
+            }
+            else {
+                goto_rows[state_ind].emplace_back(
+                    static_cast<size_t>(transition.symbol) - static_cast<size_t>(Symbol::NT_START),
+                    static_cast<GotoCell>(transition.target)
+                );
+            }
+        }
         
-        for (const auto& item : items) {
-            const auto& prod = grammar_.getProductions()[item.prod_ind];
-            
-            if (!isCompleteItem(item)) { // SHIFT
-                Symbol next_sym = symbolAtDot(item);
-                
-                if (Grammar::isTerminal(next_sym)) {
-                    ItemSet next_state_items = gotoState(items, next_sym);
-                    auto next_state_it = std::find(states_.begin(), states_.end(), next_state_items);
-
-                    if (next_state_it != states_.end()) {
-                        StateNum target_state = static_cast<StateNum>(next_state_it - states_.begin());
-                        action_table_[state_ind][next_sym] = ParseAction::shift(target_state);
-                    }
-                }
+        // законченные итемы: из ядра и эпсилон-продукции замыкания, в порядке номеров
+        complete.clear();
+        for (ItemId item : states_[state_ind]) {
+            if (isCompleteItem(item)) {
+                complete.push_back(item);
             }
-            else { //REDUCE
-                if (prod.head == Symbol::NT_START && item.dot_pos == 1) {
-                    action_table_[state_ind][Symbol::END_OF_FILE] = ParseAction::accept();
-                } 
-                else {
-                    const auto& follow = grammar_.getFollow(prod.head);
-                    for (Symbol term : follow) {
-
-                        assert(action_table_[state_ind].find(term) == action_table_[state_ind].end());
-                        
-                        action_table_[state_ind][term] = ParseAction::reduce(
-                            item.prod_ind,
-                            grammar_.productionString(item.prod_ind)
-                        );
-                        
+        }
+        if (has_epsilon_) {
+            closureMask(states_[state_ind], mask);
+            forEachBit(mask, [&](size_t nt) {
+                for (size_t prod_ind : prods_by_head_[static_cast<size_t>(Symbol::NT_START) + nt]) {
+                    if (isCompleteItem(item_offset_[prod_ind])) {
+                        complete.push_back(item_offset_[prod_ind]);
                     }
                 }
-            }
+            });
+            std::sort(complete.begin(), complete.end());
         }
-        
-        for (int i = 0; i < static_cast<int>(Symbol::COUNT); ++i) {
-            Symbol sym = static_cast<Symbol>(i);
-
-            if (Grammar::isNonTerminal(sym)) {
-                ItemSet next = gotoState(items, sym);
 
-                if (!next.empty()) {
-                    auto it = std::find(states_.begin(), states_.end(), next);
-                    if (it != states_.end()) {
-                        StateNum target_state = static_cast<StateNum>(it - states_.begin());
-                        goto_table_[state_ind][sym] = target_state;
+        for (ItemId item : complete) {
+            const size_t prod_ind = item_prod_[item];
+            const auto& prod = grammar_.getProductions()[prod_ind];
+            const ParseAction reduce = ParseAction::reduce(prod_ind);
+
+            //REDUCE
+            if (prod.head == Symbol::NT_START) {
+                setAction(action_row, state_ind, Symbol::END_OF_FILE, ParseAction::accept());
+            } 
+            else {
+                const TerminalMask mask = (mode_ == LookaheadMode::SLR)
+                    ?   grammar_.getFollow(prod.head)
+                    :   lalr_lookaheads[state_ind][prod_ind];
+                for (size_t term = 1; term < static_cast<size_t>(lexer::TokenType::COUNT); ++term) {
+                    if (mask & terminalBit(static_cast<Symbol>(term))) {
+                        setAction(action_row, state_ind, static_cast<Symbol>(term), reduce);
                     }
                 }
             }
         }
     }
+
+    storage_ = compressTables(action, goto_rows);
+    table_ = storage_.view();
 }
 
-ParsingTable::ParsingTable(const Grammar& grammar) 
-    : grammar_(grammar) 
+ParsingTable::ParsingTable(const Grammar& grammar, LookaheadMode mode, TableSource source, size_t jobs) 
+    :   grammar_(grammar) 
+    ,   symbol_count_(grammar.getSymbolCount())
+    ,   mode_(mode)
+    // потоков больше, чем ядер, построению не нужно
+    ,   build_jobs_(std::min(
+            jobs != 0 ? jobs : std::max<size_t>(std::thread::hardware_concurrency(), 1),
+            std::max<size_t>(std::thread::hardware_concurrency(), 1)
+        ))
 {
+    // собранная при компиляции таблица - SLR
+    if (source == TableSource::BUILTIN && mode_ == LookaheadMode::SLR && grammar_.isBuiltin()) {
+        table_ = static_table::BUILTIN_COMPRESSED.view();
+        return;
+    }
+
     buildCanonicalCollection();
     buildTables();
 }
 
-ParseAction ParsingTable::getAction(StateNum state, Symbol terminal) const {
-    if (state >= static_cast<StateNum>(action_table_.size())) {
-        return ParseAction::error();
+ParsingTable::ParsingTable(const Grammar& grammar, const std::string& table_filename)
+    :   grammar_(grammar)
+    ,   symbol_count_(grammar.getSymbolCount())
+    ,   table_file_(std::make_unique<utils::MappedFile>(table_filename))
+{
+    const std::string_view data = table_file_->view();
+
+    TableFileHeader header{};
+    if (data.size() < sizeof(header)) {
+        utils::THROW("Table file '" + table_filename + "' is too short");
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, TableFileHeader::MAGIC, sizeof(header.magic)) != 0) {
+        utils::THROW("'" + table_filename + "' is not a parsing table file");
+    }
+    if (header.version != TableFileHeader::VERSION || header.byte_order != TableFileHeader::ORDER_MARK) {
+        utils::THROW("Table file '" + table_filename + "' has unsupported version or byte order");
     }
-    auto it = action_table_[state].find(terminal);
-    return (it != action_table_[state].end()) ? it->second : ParseAction::error();
+    if (header.grammar_hash != grammar_.hash() 
+        || header.symbol_count != static_cast<uint32_t>(symbol_count_)) {
+        utils::THROW("Table file '" + table_filename + "' was built for another grammar");
+    }
+
+    const size_t state_count = header.state_count;
+    const size_t row_cells   = static_cast<size_t>(header.row_count) * TERMINAL_COUNT;
+    const size_t slot_count  = header.goto_slot_count;
+
+    const size_t conflict_count = header.conflict_count;
+
+    const size_t expected_size = sizeof(header)
+        + state_count * (sizeof(TerminalMask) + sizeof(ActionCell) + sizeof(uint32_t) + sizeof(uint32_t))
+        + row_cells * sizeof(ActionCell)
+        + slot_count * (sizeof(uint32_t) + sizeof(GotoCell))
+        + conflict_count * sizeof(TableFileConflict);
+
+    if (data.size() != expected_size) {
+        utils::THROW("Table file '" + table_filename + "' has wrong size");
+    }
+
+    // Маски (8 байт) идут первыми, поэтому все массивы выровнены
+    const char* pos = data.data() + sizeof(header);
+    auto take = [&pos]<typename T>(const T*& field, size_t count) {
+        field = reinterpret_cast<const T*>(pos);
+        pos += count * sizeof(T);
+    };
+
+    auto corrupted = [&table_filename] {
+        utils::THROW("Table file '" + table_filename + "' is corrupted");
+    };
+
+    if (header.lookahead_mode != static_cast<uint32_t>(LookaheadMode::SLR) 
+        && header.lookahead_mode != static_cast<uint32_t>(LookaheadMode::LALR)) {
+        corrupted();
+    }
+    mode_ = static_cast<LookaheadMode>(header.lookahead_mode);
+
+    table_.state_count      = state_count;
+    table_.row_count        = header.row_count;
+    table_.goto_slot_count  = slot_count;
+    take(table_.lookahead_mask, state_count);
+    take(table_.default_action, state_count);
+    take(table_.action_row,     state_count);
+    take(table_.action_rows,    row_cells);
+    take(table_.goto_base,      state_count);
+    take(table_.goto_check,     slot_count);
+    take(table_.goto_next,      slot_count);
+
+    // Ячейки проверяются целиком, чтобы разбор по таблице не вышел за состояния и продукции
+    const size_t prod_count = grammar_.getProductions().size();
+
+    auto validTarget = [&](ActionCell cell) {
+        switch (ParseAction::cellType(cell)) {
+            case ActionType::SHIFT:     return ParseAction::cellTarget(cell) < state_count;
+            case ActionType::REDUCE:    return ParseAction::cellTarget(cell) < prod_count;
+            default:                    return true;
+        }
+    };
+
+    for (size_t slot = 0; slot < slot_count; ++slot) {
+        if (table_.goto_check[slot] < state_count && table_.goto_next[slot] >= state_count) {
+            corrupted();
+        }
+    }
+    for (size_t state = 0; state < state_count; ++state) {
+        if (table_.action_row[state] >= table_.row_count || table_.goto_base[state] > slot_count) {
+            corrupted();
+        }
+    }
+
+    // accept - только в состоянии, куда из 0 ведёт goto по правой части пополняющей продукции
+    const auto accept_state = (state_count > 0) 
+        ?   getGoto(0, grammar_.getProductions()[0].body.front()) 
+        :   std::nullopt;
+
+    for (size_t state = 0; state < state_count; ++state) {
+        const ActionCell* row = table_.action_rows + table_.action_row[state] * TERMINAL_COUNT;
+        for (const ActionCell cell : std::span(row, TERMINAL_COUNT)) {
+            if (!validTarget(cell) || (ParseAction::cellType(cell) == ActionType::ACCEPT && accept_state != state)) {
+                corrupted();
+            }
+        }
+        const ActionCell default_cell = table_.default_action[state];
+        if (ParseAction::cellType(default_cell) != ActionType::REDUCE 
+            && default_cell != ParseAction::error().pack()) {
+            corrupted();
+        }
+        if (!validTarget(default_cell)) {
+            corrupted();
+        }
+    }
+
+    // записи конфликтов не выровнены, поэтому копируются
+    conflicts_.reserve(conflict_count);
+    for (size_t conflict_ind = 0; conflict_ind < conflict_count; ++conflict_ind) {
+        TableFileConflict record{};
+        std::memcpy(&record, pos + conflict_ind * sizeof(record), sizeof(record));
+
+        if (record.state >= state_count || record.lookahead >= TERMINAL_COUNT
+            || record.type > static_cast<uint32_t>(ConflictType::REDUCE_REDUCE)
+            || !validTarget(record.chosen) || !validTarget(record.rejected)) {
+            corrupted();
+        }
+        conflicts_.push_back({
+            static_cast<ConflictType>(record.type),
+            record.state,
+            static_cast<Symbol>(record.lookahead),
+            {ParseAction::cellType(record.chosen), ParseAction::cellTarget(record.chosen)},
+            {ParseAction::cellType(record.rejected), ParseAction::cellTarget(record.rejected)}
+        });
+    }
+}
+
+void ParsingTable::save(const std::string& table_filename) const {
+    std::ofstream file(table_filename, std::ios::binary);
+    if (!file.is_open()) {
+        utils::THROW("Can't open table file '" + table_filename + "'");
+    }
+
+    TableFileHeader header{};
+    std::memcpy(header.magic, TableFileHeader::MAGIC, sizeof(header.magic));
+    header.version      = TableFileHeader::VERSION;
+    header.byte_order   = TableFileHeader::ORDER_MARK;
+    header.grammar_hash = grammar_.hash();
+    header.symbol_count = static_cast<uint32_t>(symbol_count_);
+    header.state_count  = static_cast<uint32_t>(table_.state_count);
+    header.lookahead_mode = static_cast<uint32_t>(mode_);
+    header.row_count    = static_cast<uint32_t>(table_.row_count);
+    header.goto_slot_count = static_cast<uint32_t>(table_.goto_slot_count);
+    header.conflict_count = static_cast<uint32_t>(conflicts_.size());
+
+    auto put = [&file]<typename T>(const T* field, size_t count) {
+        file.write(reinterpret_cast<const char*>(field), static_cast<std::streamsize>(count * sizeof(T)));
+    };
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    put(table_.lookahead_mask, table_.state_count);
+    put(table_.default_action, table_.state_count);
+    put(table_.action_row,     table_.state_count);
+    put(table_.action_rows,    table_.row_count * TERMINAL_COUNT);
+    put(table_.goto_base,      table_.state_count);
+    put(table_.goto_check,     table_.goto_slot_count);
+    put(table_.goto_next,      table_.goto_slot_count);
+
+    for (const auto& conflict : conflicts_) {
+        const TableFileConflict record{
+            conflict.state,
+            static_cast<uint32_t>(conflict.type),
+            static_cast<uint32_t>(conflict.lookahead),
+            conflict.chosen.pack(),
+            conflict.rejected.pack()
+        };
+        put(&record, 1);
+    }
+
+    if (!file) {
+        utils::THROW("Can't write table file '" + table_filename + "'");
+    }
+}
+
+ActionCell ParsingTable::getActionCell(StateNum state, Symbol terminal) const noexcept {
+    const size_t term_ind = static_cast<size_t>(terminal);
+
+    if (state >= static_cast<StateNum>(table_.state_count) || term_ind >= TERMINAL_COUNT
+        || !(table_.lookahead_mask[state] & (TerminalMask{1} << term_ind))) {
+        return ParseAction::error().pack();
+    }
+
+    // ERROR в строке при допустимом терминале - место reduce по умолчанию
+    const ActionCell cell = table_.action_rows[table_.action_row[state] * TERMINAL_COUNT + term_ind];
+    return (cell != ParseAction::error().pack()) ? cell : table_.default_action[state];
+}
+
+TerminalMask ParsingTable::getExpected(StateNum state) const noexcept {
+    return (state < static_cast<StateNum>(table_.state_count)) ? table_.lookahead_mask[state] : 0;
+}
+
+ParseAction ParsingTable::getAction(StateNum state, Symbol terminal) const {
+    const ActionCell cell = getActionCell(state, terminal);
+    return {ParseAction::cellType(cell), ParseAction::cellTarget(cell)};
 }
 
 std::optional<StateNum> ParsingTable::getGoto(StateNum state, Symbol non_terminal) const {
-    if (state >= static_cast<StateNum>(goto_table_.size())) {
+    const size_t sym_ind = static_cast<size_t>(non_terminal);
+
+    if (state >= static_cast<StateNum>(table_.state_count) || !Grammar::isNonTerminal(non_terminal) 
+        || sym_ind >= symbol_count_) {
+        return std::nullopt;
+    }
+
+    const size_t slot = table_.goto_base[state] + (sym_ind - static_cast<size_t>(Symbol::NT_START));
+    if (slot >= table_.goto_slot_count || table_.goto_check[slot] != state) {
         return std::nullopt;
     }
-    auto it = goto_table_[state].find(non_terminal);
-    return (it != goto_table_[state].end()) ? std::optional<StateNum>(it->second) : std::nullopt;
+    return table_.goto_next[slot];
 }
 
 
 void ParsingTable::print(std::ostream& out) const {
     
-    out << "\n=== SLR Parsing Table ===\n";
-    out << "States: " << states_.size() << "\n";
+    out << "\n=== " << (mode_ == LookaheadMode::LALR ? "LALR" : "SLR") << " Parsing Table ===\n";
+    out << "States: " << table_.state_count << "\n";
     
 
     out << "\n===ACTION table===\n";
     
     out << std::right << std::setw(15) << "State";
 
-    for (int s = 0; s < static_cast<int>(Symbol::COUNT); ++s) {
+    for (int s = 0; s < static_cast<int>(symbol_count_); ++s) {
         Symbol sym = static_cast<Symbol>(s);
         if (Grammar::isTerminal(sym)) {
-            out << std::setw(15) << Grammar::getSymbolStr(sym);
+            out << std::setw(15) << grammar_.getSymbolStr(sym);
         }
     }
     
     out << "\n" << std::string(100, '-') << "\n";
     
-    for (StateNum state = 0; state < static_cast<StateNum>(states_.size()); ++state) {
+    for (StateNum state = 0; state < static_cast<StateNum>(table_.state_count); ++state) {
         out << std::right << std::setw(15) << state;
         
-        for (int i = 0; i < static_cast<int>(Symbol::COUNT); ++i) {
+        for (int i = 0; i < static_cast<int>(symbol_count_); ++i) {
             Symbol sym = static_cast<Symbol>(i);
             
             if (Grammar::isTerminal(sym)) {
-                auto it = action_table_[state].find(sym);
-
-                if (it != action_table_[state].end()) {
-                    const auto& act = it->second;
-                    std::string cell;
-
-                    switch (act.type) {
-                        case ActionType::SHIFT:
-                            cell = "s" + std::to_string(act.target); 
-                            break;
-                        case ActionType::REDUCE:
-                            cell = "r" + std::to_string(act.target); 
-                            break;
-                        case ActionType::ACCEPT:
-                            cell = "acc"; 
-                            break;
-                        case ActionType::ERROR:
-                            cell = "err"; 
-                            break;
-                    }
-                    out << std::setw(15) << cell;
+                const ParseAction act = getAction(state, sym);
+
+                if (act.type != ActionType::ERROR) {
+                    out << std::setw(15) << cellToString(act);
                 } 
                 else {
                     out << std::setw(15) << "-";
@@ -266,25 +930,25 @@ void ParsingTable::print(std::ostream& out) const {
     
     out << std::right << std::setw(15) << "State";
 
-    for (int i = 0; i < static_cast<int>(Symbol::COUNT); ++i) {
+    for (int i = 0; i < static_cast<int>(symbol_count_); ++i) {
         Symbol sym = static_cast<Symbol>(i);
         if (Grammar::isNonTerminal(sym)) {
-            out << std::setw(15) << Grammar::getSymbolStr(sym);
+            out << std::setw(15) << grammar_.getSymbolStr(sym);
         }
     }
 
     out << "\n" << std::string(100, '-') << "\n";
     
-    for (StateNum state_ind = 0; state_ind < static_cast<StateNum>(states_.size()); ++state_ind) {
+    for (StateNum state_ind = 0; state_ind < static_cast<StateNum>(table_.state_count); ++state_ind) {
         out << std::right << std::setw(15) << state_ind;
         
-        for (int i = 0; i < static_cast<int>(Symbol::COUNT); ++i) {
+        for (int i = 0; i < static_cast<int>(symbol_count_); ++i) {
             Symbol sym = static_cast<Symbol>(i);
 
             if (Grammar::isNonTerminal(sym)) {
-                auto it = goto_table_[state_ind].find(sym);
-                if (it != goto_table_[state_ind].end()) {
-                    out << std::setw(15) << it->second;
+                auto target = getGoto(state_ind, sym);
+                if (target) {
+                    out << std::setw(15) << *target;
                 } 
                 else {
                     out << std::setw(15) << "-";
@@ -293,6 +957,35 @@ void ParsingTable::print(std::ostream& out) const {
         }
         out << "\n";
     }
+
+    if (!conflicts_.empty()) {
+        printConflicts(out);
+    }
+}
+
+void ParsingTable::printConflicts(std::ostream& out) const {
+    out << "\n===Conflicts (" << conflicts_.size() << ")===\n";
+
+    for (const auto& conflict : conflicts_) {
+        out << "state " << conflict.state 
+            << ", lookahead " << grammar_.getSymbolStr(conflict.lookahead) << ": "
+            << (conflict.type == ConflictType::SHIFT_REDUCE ? "shift/reduce" : "reduce/reduce")
+            << ", chosen " << cellToString(conflict.chosen)
+            << ", rejected " << cellToString(conflict.rejected) << "\n";
+    }
+}
+
+LookaheadMode                   ParsingTable::getLookaheadMode  () const noexcept { return mode_; }
+const std::vector<Conflict>&    ParsingTable::getConflicts      () const noexcept { return conflicts_; }
+
+std::optional<LookaheadMode> ParsingTable::lookaheadFromStr(std::string_view str) noexcept {
+    if (str == "slr") {
+        return LookaheadMode::SLR;
+    }
+    if (str == "lalr") {
+        return LookaheadMode::LALR;
+    }
+    return std::nullopt;
 }
 
 }
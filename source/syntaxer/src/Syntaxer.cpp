@@ -1,6 +1,7 @@
 #include "syntaxer/Syntaxer.hpp"
 
 #include <iomanip>
+#include <limits>
 #include <sstream>
 #include <string>
 
@@ -10,96 +11,240 @@
 namespace slr {
 namespace syntaxer {
 
-Syntaxer::Syntaxer(const Grammar& grammar, const ParsingTable& table)
-    : grammar_(grammar), table_(table) 
+Syntaxer::Syntaxer(const Grammar& grammar, const ParsingTable& table, ParseMode mode)
+    : grammar_(grammar), table_(table), mode_(mode)
 {}
 
+void        Syntaxer::setMode       (ParseMode mode)    noexcept { mode_ = mode; }
+ParseMode   Syntaxer::getMode       ()          const   noexcept { return mode_; }
+void        Syntaxer::setTraceLimit (size_t limit)      noexcept { trace_limit_ = limit; }
+size_t      Syntaxer::getTraceLimit ()          const   noexcept { return trace_limit_; }
+void        Syntaxer::setBuildAst   (bool build)        noexcept { build_ast_ = build; }
+bool        Syntaxer::getBuildAst   ()          const   noexcept { return build_ast_; }
+void        Syntaxer::setRecover    (bool recover)      noexcept { recover_ = recover; }
+bool        Syntaxer::getRecover    ()          const   noexcept { return recover_; }
+
 ParseResult Syntaxer::parse(const std::vector<lexer::Token>& tokens) {
+    lexer::VectorTokenStream stream(tokens);
+    return parse(stream);
+}
+
+ParseResult Syntaxer::parse(lexer::TokenStream& tokens) {
     ParseResult result;
+    result.trace = ParseTrace(trace_limit_);
     result.error_message = std::nullopt;
+
+    const bool trace = (mode_ == ParseMode::TRACE);
+    Ast* ast = build_ast_ ? &result.ast : nullptr;
     
     state_stack_.clear();
-    symbol_stack_.clear();
-    
     state_stack_.push_back(0);
-    symbol_stack_.push_back({Symbol::END_OF_FILE, tokens.back().value});
+    node_stack_.clear();
     
     size_t token_pos = 0;
+    const lexer::Token* token = &tokens.next();
+
+    // позиция токена, на котором было последнее восстановление
+    constexpr size_t NOT_RECOVERED = std::numeric_limits<size_t>::max();
+    size_t recovered_pos = NOT_RECOVERED;
+
+    auto setError = [&](std::string message, TerminalMask expected = 0) {
+        const ParseErrorLocation location{token_pos, token->line};
+        if (!result.error_message.has_value()) {
+            result.error_message = message;
+            result.error_location = location;
+        }
+        result.diagnostics.push_back({std::move(message), location, expected, 0});
+        result.ast.clear();
+    };
     
     while (true) {
-        ParseStep step;
-        step.stack = stackToString();
-        step.input = inputToString(tokens, token_pos);
-        
-        int current_state = state_stack_.back();
-        Symbol lookahead = Grammar::fromTokenType(tokens[token_pos].type);
+        StateNum current_state = state_stack_.back();
+        Symbol lookahead = Grammar::fromTokenType(token->type);
         
         ParseAction action = table_.getAction(current_state, lookahead);
-        step.action = actionToString(action);
-        result.steps.push_back(step);
+
+        if (trace) {
+            auto evicted = result.trace.push({action, token_pos, lookahead});
+            if (evicted) {
+                applyStep(result.trace.getBaseStack(), *evicted);
+            }
+        }
         
         switch (action.type) {
             case ActionType::SHIFT: {
-                if (!doShift(action, tokens, token_pos)) {
-                    result.error_message = "Shift failed. Line " + std::to_string(tokens[token_pos].line);
+                if (!doShift(action, *token, ast)) {
+                    setError("Shift failed. Line " + std::to_string(token->line));
                     return result;
                 }
+                token = &tokens.next();
+                ++token_pos;
                 break;
             }
             
             case ActionType::REDUCE: {
-                if (!doReduce(action)) {
-                    result.error_message = "Reduce failed. Line " + std::to_string(tokens[token_pos].line);
+                if (!doReduce(action, token->line, ast)) {
+                    setError("Reduce failed. Line " + std::to_string(token->line));
                     return result;
                 }
                 break;
             }
             
             case ActionType::ACCEPT: {
+                if (ast) {
+                    ast->setRoot(node_stack_.back());
+                }
                 return result;
             }
             
             case ActionType::ERROR: {
-                std::ostringstream oss;
-                oss << "Syntax error in line " << tokens[token_pos].line << ", token is " 
-                    << tokens[token_pos].value
-                    << "(state " << current_state << ")";
-                result.error_message = oss.str();
-                return result;
+                // о токене сообщается один раз: повторная ошибка на нём же - следствие восстановления
+                if (token_pos != recovered_pos) {
+                    std::ostringstream oss;
+                    oss << "Syntax error in line " << token->line << ", token is " 
+                        << token->value
+                        << "(state " << current_state << ")";
+                    setError(oss.str(), table_.getExpected(current_state));
+                }
+                if (!recover_) {
+                    return result;
+                }
+
+                // после ошибки дерево не строится
+                ast = nullptr;
+
+                const size_t error_pos = token_pos;
+                const auto sync = recover(tokens, token, token_pos, error_pos == recovered_pos);
+                if (!sync) {
+                    return result;
+                }
+                result.diagnostics.back().skipped += token_pos - error_pos;
+                recovered_pos = token_pos;
+
+                // шаг восстановления: в стеке символов (с $ внизу) остаются target, затем кладётся sync
+                if (trace) {
+                    const ParseStep step{{ActionType::ERROR, state_stack_.size() - 1}, token_pos, *sync};
+                    auto evicted = result.trace.push(step);
+                    if (evicted) {
+                        applyStep(result.trace.getBaseStack(), *evicted);
+                    }
+                }
+                break;
             }
 
             default: {
-                result.error_message = "Unknown action type. Line " + std::to_string(tokens[token_pos].line);
+                setError("Unknown action type. Line " + std::to_string(token->line));
                 return result;
             }
         }
     }
 }
 
-bool Syntaxer::doShift(
-    const ParseAction& action, const std::vector<lexer::Token>& tokens, size_t& token_pos
+TerminalMask Syntaxer::syncMask(StateNum state) {
+    if (state >= sync_known_.size()) {
+        sync_masks_.resize(table_.getStateCount(), 0);
+        sync_known_.resize(table_.getStateCount(), false);
+    }
+    if (sync_known_[state]) {
+        return sync_masks_[state];
+    }
+
+    TerminalMask mask = 0;
+    for (size_t sym_ind = static_cast<size_t>(Symbol::NT_START) + 1; sym_ind < grammar_.getSymbolCount(); ++sym_ind) {
+        const Symbol non_terminal = static_cast<Symbol>(sym_ind);
+        if (const auto next = table_.getGoto(state, non_terminal)) {
+            mask |= grammar_.getFollow(non_terminal) & table_.getExpected(*next);
+        }
+    }
+
+    sync_known_[state] = true;
+    sync_masks_[state] = mask;
+    return mask;
+}
+
+std::optional<Symbol> Syntaxer::recover(
+    lexer::TokenStream& tokens, const lexer::Token*& token, size_t& token_pos, bool skip_current
 ) {
-    Symbol sym = Grammar::fromTokenType(tokens[token_pos].type);
-    
-    symbol_stack_.push_back({sym, tokens[token_pos].value});
+    auto advance = [&] {
+        if (token->type == lexer::TokenType::END_OF_FILE) {
+            return false;
+        }
+        token = &tokens.next();
+        ++token_pos;
+        return true;
+    };
+    auto bit = [&] { return TerminalMask{1} << static_cast<size_t>(token->type); };
+
+    TerminalMask sync = 0;
+    for (StateNum state : state_stack_) {
+        sync |= syncMask(state);
+    }
+
+    if (skip_current && !advance()) {
+        return std::nullopt;
+    }
+    while (!(sync & bit())) {
+        if (!advance()) {
+            return std::nullopt;
+        }
+    }
+
+    const Symbol lookahead = Grammar::fromTokenType(token->type);
+
+    for (size_t depth = state_stack_.size(); depth-- > 0;) {
+        const StateNum state = state_stack_[depth];
+        if (!(syncMask(state) & bit())) {
+            continue;
+        }
+
+        for (size_t sym_ind = static_cast<size_t>(Symbol::NT_START) + 1; sym_ind < grammar_.getSymbolCount(); ++sym_ind) {
+            const Symbol non_terminal = static_cast<Symbol>(sym_ind);
+            const auto next = table_.getGoto(state, non_terminal);
+            if (next && (grammar_.getFollow(non_terminal) & bit()) 
+                && table_.getAction(*next, lookahead).type != ActionType::ERROR) {
+                state_stack_.resize(depth + 1);
+                state_stack_.push_back(*next);
+                return non_terminal;
+            }
+        }
+    }
+
+    return std::nullopt;
+}
+
+bool Syntaxer::doShift(const ParseAction& action, const lexer::Token& token, Ast* ast) {
     state_stack_.push_back(action.target);
-    ++token_pos;
+
+    if (ast) {
+        node_stack_.push_back(ast->addLeaf(Grammar::fromTokenType(token.type), token.value, token.line));
+    }
     
     return true;
 }
 
-bool Syntaxer::doReduce(const ParseAction& action) {
+bool Syntaxer::doReduce(const ParseAction& action, int line, Ast* ast) {
     const auto& prod = grammar_.getProductions()[action.target];
     
     size_t body_size = prod.body.size();
-    for (size_t i = 0; i < body_size; ++i) {
-        state_stack_.pop_back();
-        symbol_stack_.pop_back();
+    // таблица из файла может требовать свёртки глубже стека
+    if (body_size >= state_stack_.size()) {
+        return false;
+    }
+    state_stack_.resize(state_stack_.size() - body_size);
+
+    if (ast) {
+        const size_t children_begin = node_stack_.size() - body_size;
+        const NodeInd node = ast->addNode(
+            prod.head, 
+            action.target, 
+            std::span<const NodeInd>(node_stack_.data() + children_begin, body_size),
+            line
+        );
+        node_stack_.resize(children_begin);
+        node_stack_.push_back(node);
     }
     
-    symbol_stack_.push_back({prod.head, {}});
-    
-    int prev_state = state_stack_.back();
+    StateNum prev_state = state_stack_.back();
     auto goto_state = table_.getGoto(prev_state, prod.head);
     
     if (!goto_state) {
@@ -111,15 +256,44 @@ bool Syntaxer::doReduce(const ParseAction& action) {
     return true;
 }
 
-std::string Syntaxer::stackToString() const {
+void Syntaxer::applyStep(std::vector<Symbol>& stack, const ParseStep& step) const {
+    switch (step.action.type) {
+        case ActionType::SHIFT:
+            stack.push_back(step.lookahead);
+            break;
+
+        case ActionType::REDUCE: {
+            const auto& prod = grammar_.getProductions()[step.action.target];
+            // неудавшаяся свёртка стек не меняет
+            if (prod.body.size() >= stack.size()) {
+                break;
+            }
+            stack.resize(stack.size() - prod.body.size());
+            stack.push_back(prod.head);
+            break;
+        }
+
+        case ActionType::ERROR:
+            // шаг восстановления
+            if (step.action.target != ParseAction::TARGET_POISION) {
+                stack.resize(step.action.target);
+                stack.push_back(step.lookahead);
+            }
+            break;
+
+        case ActionType::ACCEPT:
+            break;
+    }
+}
+
+std::string Syntaxer::stackToString(const std::vector<Symbol>& stack) const {
     std::ostringstream oss;
     
-    for (size_t i = 0; i < symbol_stack_.size(); ++i) {
-        auto sym = symbol_stack_[i];
-        oss << (Grammar::isTerminal(sym.first) 
-            ?   Grammar::getPrettySymbolStr(sym.first) 
-            :   sym.second) 
-            <<  "";
+    // нетерминалы в стеке не отображаются
+    for (Symbol sym : stack) {
+        if (Grammar::isTerminal(sym)) {
+            oss << Grammar::getPrettySymbolStr(sym);
+        }
     }
     
     return oss.str();
@@ -135,7 +309,8 @@ std::string Syntaxer::inputToString(const std::vector<lexer::Token>& tokens, siz
     return oss.str();
 }
 
-std::string Syntaxer::actionToString(const ParseAction& action) const {
+std::string Syntaxer::actionToString(const ParseStep& step) const {
+    const ParseAction& action = step.action;
     std::ostringstream oss;
     
     switch (action.type) {
@@ -143,25 +318,42 @@ std::string Syntaxer::actionToString(const ParseAction& action) const {
             oss << "shift " << action.target;
             break;
             
-        case ActionType::REDUCE: {
-            const auto& prod = grammar_.getProductions()[action.target];
-            oss << "reduce " << prod.name;
+        case ActionType::REDUCE:
+            oss << "reduce " << grammar_.productionString(action.target);
             break;
-        }
             
         case ActionType::ACCEPT:
             oss << "accept";
             break;
             
         case ActionType::ERROR:
-            oss << "error";
+            if (action.target != ParseAction::TARGET_POISION) {
+                oss << "recover " << grammar_.getSymbolStr(step.lookahead);
+            }
+            else {
+                oss << "error";
+            }
             break;
     }
     
     return oss.str();
 }
 
-void Syntaxer::print(const ParseResult& result, std::ostream& out) const {
+std::string Syntaxer::maskToString(TerminalMask mask) const {
+    std::ostringstream oss;
+
+    for (size_t term_ind = 0; term_ind < TERMINAL_COUNT; ++term_ind) {
+        if (mask & (TerminalMask{1} << term_ind)) {
+            oss << " " << grammar_.getSymbolStr(static_cast<Symbol>(term_ind));
+        }
+    }
+
+    return oss.str();
+}
+
+void Syntaxer::print(
+    const ParseResult& result, const std::vector<lexer::Token>& tokens, std::ostream& out
+) const {
     out << "\n===Syntaxer result===\n";
     out << "Result: ";
 
@@ -172,6 +364,22 @@ void Syntaxer::print(const ParseResult& result, std::ostream& out) const {
         out << "ERROR\n" << "Message: " << *result.error_message << "\n";
     }
 
+    if (recover_ && !result.diagnostics.empty()) {
+        out << "Errors: " << result.diagnostics.size() << "\n";
+        for (const auto& diagnostic : result.diagnostics) {
+            out << "  " << diagnostic.message 
+                << "; expected:" << maskToString(diagnostic.expected)
+                << "; skipped " << diagnostic.skipped << "\n";
+        }
+        out << "\n";
+    }
+
+    const ParseTrace& trace = result.trace;
+
+    if (trace.empty()) {
+        return;
+    }
+
     out << std::left 
         << std::setw(5)  << "Ind"
         << std::setw(50) << "STACK" 
@@ -179,13 +387,21 @@ void Syntaxer::print(const ParseResult& result, std::ostream& out) const {
         << "ACTION" << "\n"
         << std::string(150, '-') << "\n";
     
-    for (size_t step_ind = 0; step_ind < result.steps.size(); ++step_ind) {
-        const auto& step = result.steps[step_ind];
+    if (trace.getDroppedCount() != 0) {
+        out << "... " << trace.getDroppedCount() << " earlier steps dropped\n";
+    }
+
+    std::vector<Symbol> stack = trace.getBaseStack();
+    
+    for (size_t step_ind = 0; step_ind < trace.size(); ++step_ind) {
+        const auto& step = trace[step_ind];
         out << std::left 
-            << std::setw(5)  << step_ind
-            << std::setw(50) << step.stack 
-            << std::setw(50) << step.input 
-            << step.action << "\n";
+            << std::setw(5)  << trace.getDroppedCount() + step_ind
+            << std::setw(50) << stackToString(stack) 
+            << std::setw(50) << inputToString(tokens, step.token_pos) 
+            << actionToString(step) << "\n";
+
+        applyStep(stack, step);
     }
     
     out << std::string(150, '-') << "\n";
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace slr {
+namespace utils {
+
+// Read-only отображение файла в память. Если mmap невозможен (пустой файл, пайп),
+// содержимое читается в собственный буфер.
+class MappedFile {
+
+public:
+
+    explicit MappedFile(const std::string& filename);
+
+    MappedFile(const MappedFile& that) = delete;
+    MappedFile(const MappedFile&& that) = delete;
+
+    MappedFile& operator=(const MappedFile& that) = delete;
+    MappedFile& operator=(const MappedFile&& that) = delete;
+
+    ~MappedFile();
+
+    std::string_view    view    () const noexcept;
+    bool                isMapped() const noexcept;
+
+private:
+
+    const char* data_   = nullptr;
+    size_t      size_   = 0;
+    bool        mapped_ = false;
+    std::string storage_;
+};
+
+}
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#include "utils/MappedFile.hpp"
+
+#include "utils/common.hpp"
+
+#include <fstream>
+#include <iterator>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace slr {
+namespace utils {
+
+MappedFile::MappedFile(const std::string& filename) {
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        THROW("Can't open file '" + filename + "'");
+    }
+
+    struct stat file_stat{};
+    if (::fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) && file_stat.st_size > 0) {
+        void* addr = ::mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            data_   = static_cast<const char*>(addr);
+            size_   = static_cast<size_t>(file_stat.st_size);
+            mapped_ = true;
+            ::madvise(addr, size_, MADV_SEQUENTIAL);
+        }
+    }
+    ::close(fd);
+
+    if (!mapped_) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            THROW("Can't open file '" + filename + "'");
+        }
+        storage_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        data_ = storage_.data();
+        size_ = storage_.size();
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (mapped_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+std::string_view    MappedFile::view    () const noexcept { return {data_, size_}; }
+bool                MappedFile::isMapped() const noexcept { return mapped_; }
+
+}
+}
\ No newline at end of file
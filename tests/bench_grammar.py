@@ -0,0 +1,48 @@
+import itertools
+import subprocess
+import tempfile
+import time
+from pathlib import Path
+
+BASE_DIR = Path(__file__).parent.parent
+PARSER = BASE_DIR / "build" / "SLRParser"
+
+DIGITS = ["NUM", "ID", "'+'", "'-'", "'*'", "'/'", "'('", "')'"]
+
+# Число правил <rK> и длина их "кода" из терминалов
+SIZES = [(64, 2), (512, 3), (4096, 4)]
+
+RUNS = 3
+
+
+# SLR-грамматика из rule_count правил: каждое начинается своим кодом из терминалов,
+# так что автомат - дерево префиксов на тысячи состояний
+def make_grammar(rule_count, code_len):
+    codes = itertools.islice(itertools.product(DIGITS, repeat=code_len), rule_count)
+
+    lines = ["<top> ::= " + " | ".join(f"<r{i}>" for i in range(rule_count))]
+    for i, code in enumerate(codes):
+        lines.append(f"<r{i}> ::= {' '.join(code)} <val>")
+    lines.append("<val> ::= NUM | ID | '(' <top> ')'")
+
+    return "\n".join(lines) + "\n"
+
+
+with tempfile.TemporaryDirectory() as tmp_dir:
+    input_file = Path(tmp_dir) / "empty.popin"
+    input_file.write_text("")
+
+    for rule_count, code_len in SIZES:
+        grammar_file = Path(tmp_dir) / f"bench_{rule_count}.grammar"
+        grammar_file.write_text(make_grammar(rule_count, code_len))
+
+        cmd = [str(PARSER), "-g", str(grammar_file), "-f", "-i", str(input_file)]
+
+        best = None
+        for _ in range(RUNS):
+            start = time.perf_counter()
+            subprocess.run(cmd, stdout=subprocess.DEVNULL, check=True)
+            elapsed = time.perf_counter() - start
+            best = elapsed if best is None else min(best, elapsed)
+
+        print(f"productions: {rule_count * 2 + 4:6}  table build + run: {best * 1000:8.1f} ms")
@@ -1,4 +1,7 @@
+import re
+import struct
 import subprocess
+import tempfile
 from pathlib import Path
 
 BASE_DIR = Path(__file__).parent.parent
@@ -6,29 +9,238 @@ PARSER = BASE_DIR / "build" / "SLRParser"
 TESTS_DIR = BASE_DIR / "tests"
 REPORTS_DIR = BASE_DIR / "tests" / "reports"
 
-TEST_DIRS = ["valid", "invalid"]
+GRAMMARS_DIR = BASE_DIR / "grammars"
+
+# Директория с тестами -> аргументы, с которыми она разбирается
+TEST_DIRS = {
+    "valid": [],
+    "invalid": [],
+    "lalr": ["-g", str(GRAMMARS_DIR / "lalr_only.grammar"), "--lookahead", "lalr"],
+    "epsilon": ["-g", str(GRAMMARS_DIR / "epsilon.grammar"), "--ast"],
+    "ast": ["--ast"],
+    "eval": ["--eval", "--var", "x=3", "--var", "y=0.5"],
+    "bytecode": ["--compile", "--var", "x=3", "--bindings", str(TESTS_DIR / "bytecode.bindings")],
+    "columns": ["--compile", "--var", "z=3", "--columns", str(TESTS_DIR / "columns.csv")],
+    "cache": [],
+    "recover": ["--recover"],
+    "trace": ["--trace-limit", "4"],
+    "incremental": ["--edits", str(TESTS_DIR / "incremental.edits")],
+    "incremental_tail": ["--edits", str(TESTS_DIR / "incremental_tail.edits")],
+}
+
+TABLE_FILE = Path(tempfile.gettempdir()) / "slr_table.bin"
+
+# Альтернативные реализации, вывод которых должен совпадать с отчётом
+CROSS_CHECKS = [
+    ["--lexer", "simd"],
+    ["-j", "4"],
+    ["--load-table", str(TABLE_FILE)],
+    ["--runtime-table"],
+    ["--cache", "2"],
+    ["--cache", "2", "--eviction", "fifo"],
+]
+
+# Только для директорий со встроенной грамматикой
+BUILTIN_CROSS_CHECKS = [
+    ["-g", str(GRAMMARS_DIR / "expr.grammar"), "--runtime-table"],
+]
+
+# Строки результата: с ними сравнивается разбор без -v, где отчёт не печатает таблицу и трассу
+RESULT_PREFIXES = ("Result:", "Message:", "Errors:", "  Syntax error", "Value:", "Initial:", "Edit ")
+
+# Результат разбора в строке Initial/Edit отчёта --edits
+INCREMENTAL_STATUS = re.compile(r": (SUCCESSFULLY|ERROR \(.*\)); relexed \d+, reparsed \d+ tokens$")
+
+
+def results_match(fast_text, report_text, evaluates):
+    fast = [line for line in fast_text.splitlines() if line.startswith(RESULT_PREFIXES)]
+    report = [line for line in report_text.splitlines() if line.startswith(RESULT_PREFIXES)]
+    # с --eval/--compile без -v разбирает только вычислитель, строки Result нет
+    if evaluates:
+        report = [line for line in report if not line.startswith("Result:")]
+    return fast == report
+
+
+# Правки --edits: (OFFSET, LENGTH, TEXT), экранирование как в readEdits
+def read_edits(edits_file):
+    edits = []
+    for line in edits_file.read_text().splitlines():
+        if not line or line.startswith("#"):
+            continue
+        offset, length, *text = line.split(" ", 2)
+        text = re.sub(r"\\(.)", lambda m: {"n": "\n", "t": "\t"}.get(m.group(1), m.group(1)), text[0] if text else "")
+        edits.append((int(offset), int(length), text))
+    return edits
+
+
+# Разбор text с нуля в виде результата из отчёта --edits: SUCCESSFULLY или ERROR (сообщение)
+def full_parse_status(text):
+    run = subprocess.run([str(PARSER), "-f"], input=text, capture_output=True, text=True)
+    messages = [line for line in run.stdout.splitlines() if line.startswith("Message: ")]
+    return f"ERROR ({messages[0][len('Message: '):]})" if messages else "SUCCESSFULLY"
+
 
 for dir_name in TEST_DIRS:
     (REPORTS_DIR / dir_name).mkdir(parents=True, exist_ok=True)
 
-for dir_name in TEST_DIRS:
+failed = []
+
+for dir_name, dir_args in TEST_DIRS.items():
     test_dir = TESTS_DIR / dir_name
     report_dir = REPORTS_DIR / dir_name
-    
+
     if not test_dir.exists():
         continue
-    
-    for test_file in test_dir.glob("*.popin"):
-        output_file = report_dir / (test_file.stem + ".popout")
-        
-        cmd = [
-            str(PARSER),
-            "-i", str(test_file),
-            "-v",
-            "-o", str(output_file)
-        ]
-        
-        print(f"Running: {test_file.name} -> {output_file.name}")
-        subprocess.run(cmd)
+
+    # Один запуск на директорию: грамматика и таблица строятся один раз
+    cmd = [
+        str(PARSER),
+        "-b", str(test_dir),
+        "-v",
+    ] + dir_args
+
+    print(f"Running: {dir_name} -> {report_dir}")
+    subprocess.run(cmd + ["-o", str(report_dir), "--dump-table", str(TABLE_FILE)])
+
+    cross_checks = CROSS_CHECKS + (BUILTIN_CROSS_CHECKS if not dir_args else [])
+
+    for extra_args in cross_checks:
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            subprocess.run(cmd + ["-o", tmp_dir] + extra_args, stdout=subprocess.DEVNULL)
+
+            for test_file in sorted(test_dir.glob("*.popin")):
+                report_name = test_file.stem + ".popout"
+                check_file = Path(tmp_dir) / report_name
+
+                if check_file.read_text() != (report_dir / report_name).read_text():
+                    failed.append(f"{test_file.name} {' '.join(extra_args)}")
+                    print(f"MISMATCH: {test_file.name} with {' '.join(extra_args)}")
+
+    # -f без -v: потоковый разбор через TokenStream (пакет - по отображённым файлам, stdin - через
+    # flex-лексер, читающий поток), результат должен совпасть с отчётом
+    evaluates = "--eval" in dir_args or "--compile" in dir_args
+    fast_cmd = [str(PARSER), "-f"] + dir_args
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        subprocess.run(fast_cmd + ["-b", str(test_dir), "-o", tmp_dir], stdout=subprocess.DEVNULL)
+
+        for test_file in sorted(test_dir.glob("*.popin")):
+            report_name = test_file.stem + ".popout"
+            report_text = (report_dir / report_name).read_text()
+
+            batch_text = (Path(tmp_dir) / report_name).read_text()
+            with open(test_file) as stdin:
+                stdin_text = subprocess.run(
+                    fast_cmd, stdin=stdin, capture_output=True, text=True
+                ).stdout
+
+            for mode, fast_text in (("-f", batch_text), ("-f <stdin", stdin_text)):
+                if not results_match(fast_text, report_text, evaluates):
+                    failed.append(f"{test_file.name} {mode}")
+                    print(f"MISMATCH: {test_file.name} with {mode}")
+
+    # После каждой правки результат инкрементального разбора должен совпасть с разбором текста с нуля
+    if "--edits" in dir_args:
+        edits = read_edits(Path(dir_args[dir_args.index("--edits") + 1]))
+
+        for test_file in sorted(test_dir.glob("*.popin")):
+            report_lines = [
+                line for line in (report_dir / (test_file.stem + ".popout")).read_text().splitlines()
+                if line.startswith(("Initial: ", "Edit "))
+            ]
+            text = test_file.read_text()
+            for step, edit in enumerate([None] + edits):
+                if edit is not None:
+                    offset, length, replacement = edit
+                    text = text[:offset] + replacement + text[offset + length:]
+                incremental_status = INCREMENTAL_STATUS.search(report_lines[step]).group(1)
+                if incremental_status != full_parse_status(text):
+                    failed.append(f"{test_file.name} edit {step} vs full parse")
+                    print(f"MISMATCH: {test_file.name} after edit {step} differs from a full parse")
+
+# Входы с одним именем отчёта (invalid/error1 и trace/error1) - ошибка до запуска воркеров,
+# иначе с -j два воркера писали бы в один файл
+with tempfile.TemporaryDirectory() as tmp_dir:
+    collision = subprocess.run(
+        [str(PARSER), "-b", str(TESTS_DIR / "invalid"), "-b", str(TESTS_DIR / "trace"), "-o", tmp_dir, "-j", "4"],
+        stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL,
+    )
+    if collision.returncode == 0 or any(Path(tmp_dir).iterdir()):
+        failed.append("report name collision with -j 4")
+        print("MISMATCH: report name collision with -j 4 was not rejected")
+
+# Второй вход манифеста не существует: пакет не обрывается, а отмечает вход FAILED, и при -j 1 и
+# при -j 4 остальные шесть отчётов и сводка одинаковы
+with tempfile.TemporaryDirectory() as tmp_dir:
+    tmp_path = Path(tmp_dir)
+    manifest_inputs = sorted((TESTS_DIR / "valid").glob("*.popin"))[:6]
+    manifest_inputs.insert(1, TESTS_DIR / "valid" / "missing.popin")
+    manifest = tmp_path / "manifest.txt"
+    manifest.write_text("".join(f"{path}\n" for path in manifest_inputs))
+
+    batch_runs = {}
+    for jobs in ("1", "4"):
+        output_dir = tmp_path / f"j{jobs}"
+        run = subprocess.run(
+            [str(PARSER), "--manifest", str(manifest), "-o", str(output_dir), "-j", jobs],
+            capture_output=True, text=True,
+        )
+        reports = {path.name: path.read_text() for path in output_dir.iterdir()}
+        batch_runs[jobs] = (run.returncode != 0, run.stdout, reports)
+
+    if batch_runs["1"] != batch_runs["4"] or not batch_runs["1"][0] or len(batch_runs["1"][2]) != 6:
+        failed.append("manifest with a missing input")
+        print("MISMATCH: manifest with a missing input differs between -j 1 and -j 4")
+
+# Испорченная таблица: в состоянии 0 по любому терминалу свёртка r1/r3, глубже стека из одного
+# состояния. Загрузчик её пропускает, разбор "+" должен закончиться ошибкой, а не падением
+with tempfile.TemporaryDirectory() as tmp_dir:
+    tmp_path = Path(tmp_dir)
+    table_file = tmp_path / "table.bin"
+    subprocess.run(
+        [str(PARSER), "-i", str(TESTS_DIR / "valid" / "assoc1.popin"), "-o", str(tmp_path / "out"),
+         "--dump-table", str(table_file)],
+        stdout=subprocess.DEVNULL,
+    )
+    table = bytearray(table_file.read_bytes())
+    # заголовок 48 байт, state_count по смещению 28; затем lookahead_mask[u64] и default_action[u32]
+    state_count = struct.unpack_from("<I", table, 28)[0]
+    struct.pack_into("<Q", table, 48, (1 << 64) - 1)
+
+    edits_file = tmp_path / "plus.edits"
+    edits_file.write_text("2 0 +\n")
+
+    for prod_ind in (1, 3):
+        struct.pack_into("<I", table, 48 + 8 * state_count, (1 << 30) | prod_ind)
+        corrupted_file = tmp_path / f"r{prod_ind}.bin"
+        corrupted_file.write_bytes(table)
+
+        for mode in (["-v"], ["-f"], ["-f", "--eval"], ["--edits", str(edits_file)]):
+            run = subprocess.run(
+                [str(PARSER), "--load-table", str(corrupted_file)] + mode,
+                input="+\n", capture_output=True, text=True,
+            )
+            if run.returncode != 0 or "ERROR" not in run.stdout:
+                failed.append(f"corrupted table r{prod_ind} {' '.join(mode)}")
+                print(f"MISMATCH: corrupted table r{prod_ind} with {' '.join(mode)}")
+
+# Правка перелексирует текст с середины: лексическая ошибка в stderr - с номером строки от начала
+# документа, тем же, что в отчёте
+with tempfile.TemporaryDirectory() as tmp_dir:
+    edits_file = Path(tmp_dir) / "lexical.edits"
+    edits_file.write_text("10 0 @\n")
+
+    for lexer in ("flex", "simd"):
+        run = subprocess.run(
+            [str(PARSER), "--edits", str(edits_file), "--lexer", lexer],
+            input="x +\ny +\n1 +\n2\n", capture_output=True, text=True,
+        )
+        if "Lexical error at line 3" not in run.stderr or "Syntax error in line 3" not in run.stdout:
+            failed.append(f"relexed line numbers with --lexer {lexer}")
+            print(f"MISMATCH: relexed line numbers with --lexer {lexer}")
+
+if failed:
+    print(f"Cross-check failed: {len(failed)}")
+    exit(1)
 
 print("Done!")
\ No newline at end of file